@@ -0,0 +1,71 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "backend/commitbatch.h"
+
+#include "util/report.h"
+
+#include <utility>
+
+static thread_local CommitBatch* currentBatch = nullptr;
+
+/** Creates an empty batch and makes it the current one for the calling thread. */
+CommitBatch::CommitBatch() :
+    m_Previous(currentBatch)
+{
+    currentBatch = this;
+}
+
+/** Runs the pending syncs of the batch that were not flushed yet. */
+CommitBatch::~CommitBatch()
+{
+    Report report(nullptr);
+    flush(report);
+    currentBatch = m_Previous;
+}
+
+/** @return true if the calling thread has a batch */
+bool CommitBatch::isActive()
+{
+    return currentBatch != nullptr;
+}
+
+/** Defer bringing the kernel and udev up to date with the partition table of a device.
+    @param deviceNode the device whose partition table changed
+    @param sync the function doing it, replaces one deferred earlier for the device
+    @return true if sync was deferred, false if there is no batch and the caller has to sync now
+*/
+bool CommitBatch::defer(const QString& deviceNode, const Sync& sync)
+{
+    if (!currentBatch)
+        return false;
+
+    if (!currentBatch->m_Pending.contains(deviceNode))
+        currentBatch->m_Devices.append(deviceNode);
+    currentBatch->m_Pending.insert(deviceNode, sync);
+
+    return true;
+}
+
+/** Run the pending syncs of the current batch.
+    @param report the report to write errors to
+    @return true if all of them succeeded
+*/
+bool CommitBatch::flush(Report& report)
+{
+    if (!currentBatch)
+        return true;
+
+    // Take them first, a sync may commit again
+    const QStringList devices = std::exchange(currentBatch->m_Devices, {});
+    const QHash<QString, Sync> pending = std::exchange(currentBatch->m_Pending, {});
+
+    bool rval = true;
+    for (const QString& deviceNode : devices)
+        rval = pending.value(deviceNode)(report) && rval;
+
+    return rval;
+}
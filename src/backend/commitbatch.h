@@ -0,0 +1,57 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_COMMITBATCH_H
+#define KPMCORE_COMMITBATCH_H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+
+class Report;
+
+/** Scope in which partition table commits are coalesced per device.
+
+    Telling the kernel and udev about a changed partition table is slow, it rereads
+    the table and makes udev process every block device. While a CommitBatch exists,
+    backends hand this work to defer() instead of doing it after every change, and
+    it is done once per device when the batch is flushed. Backends may also collect
+    edits of the partition table itself and write them when the batch is flushed.
+
+    OperationRunner keeps a batch while it runs. Operation::runJob() flushes it before
+    every Job that needs the device nodes of partitions, see
+    Job::changesPartitionTableOnly(), and OperationRunner at the end of the run.
+
+    @author kpmcore contributors
+*/
+class LIBKPMCORE_EXPORT CommitBatch
+{
+    Q_DISABLE_COPY(CommitBatch)
+
+public:
+    /** Brings the kernel and udev up to date with the partition table of a device */
+    typedef std::function<bool(Report&)> Sync;
+
+public:
+    CommitBatch();
+    ~CommitBatch();
+
+public:
+    static bool isActive();
+    static bool defer(const QString& deviceNode, const Sync& sync);
+    static bool flush(Report& report);
+
+private:
+    QStringList m_Devices;          /**< devices with pending syncs in the order of their first commit */
+    QHash<QString, Sync> m_Pending;
+    CommitBatch* m_Previous;
+};
+
+#endif
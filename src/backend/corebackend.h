@@ -29,6 +29,8 @@ class QString;
 enum class ScanFlag : uint8_t {
     includeReadOnly = 0x1, /**< devices that are read-only according to the kernel */
     includeLoopback = 0x2,
+    useScanCache = 0x4, /**< reuse cached results for devices that did not change since the last scan */
+    deferUsedSpace = 0x8, /**< read the used space of unmounted file systems after the scan, see UsedSpaceReader */
 };
 Q_DECLARE_FLAGS(ScanFlags, ScanFlag)
 Q_DECLARE_OPERATORS_FOR_FLAGS(ScanFlags)
@@ -36,7 +36,7 @@ Device::Device(std::shared_ptr<DevicePrivate> d_ptr,
     d->m_TotalLogical = totalLogicalSectors;
     d->m_PartitionTable = nullptr;
     d->m_IconName = iconName.isEmpty() ? QStringLiteral("drive-harddisk") : iconName;
-    d->m_SmartStatus = type == Device::Type::Disk_Device ? std::make_shared<SmartStatus>(deviceNode) : nullptr;
+    d->m_SmartStatus = nullptr; // read on first use, see smartStatus()
     d->m_Type = type;
 }
 
@@ -53,9 +53,11 @@ Device::Device(const Device& other)
     d->m_TotalLogical = other.d->m_TotalLogical;
     d->m_PartitionTable = nullptr;
     d->m_IconName = other.d->m_IconName;
-    d->m_SmartStatus = nullptr;
     d->m_Type = other.d->m_Type;
-    d->m_SmartStatus = other.d->m_SmartStatus;
+    {
+        QMutexLocker locker(&other.d->m_SmartStatusMutex);
+        d->m_SmartStatus = other.d->m_SmartStatus;
+    }
 
     if (other.d->m_PartitionTable)
         d->m_PartitionTable = new PartitionTable(*other.d->m_PartitionTable);
@@ -132,14 +134,44 @@ void Device::setIconName(const QString& name)
     d->m_IconName = name;
 }
 
+static SmartStatus* loadSmartStatus(DevicePrivate& d)
+{
+    // Devices are shared between threads, only one of them may run smartctl
+    QMutexLocker locker(&d.m_SmartStatusMutex);
+    if (!d.m_SmartStatus && d.m_Type == Device::Type::Disk_Device)
+        d.m_SmartStatus = std::make_shared<SmartStatus>(d.m_DeviceNode);
+
+    return d.m_SmartStatus.get();
+}
+
+/** Get the SMART data of a disk.
+
+    smartctl is only run the first time the SMART data of a Device is asked for, so
+    scanning devices does not wait for it. Use SmartCollector to read the data of many
+    disks in the background beforehand and hand it over with setSmartStatus().
+
+    @return the SMART data, only valid for Disk_Device
+*/
 SmartStatus& Device::smartStatus()
 {
-    return *(d->m_SmartStatus);
+    return *loadSmartStatus(*d);
 }
 
 const SmartStatus& Device::smartStatus() const
 {
-    return *(d->m_SmartStatus);
+    return *loadSmartStatus(*d);
+}
+
+/** Set the SMART data of a disk, e.g. one reported by SmartCollector::statusReady().
+
+    References returned by smartStatus() before are no longer valid afterwards.
+
+    @param status the new SMART data
+*/
+void Device::setSmartStatus(std::shared_ptr<SmartStatus> status)
+{
+    QMutexLocker locker(&d->m_SmartStatusMutex);
+    d->m_SmartStatus = std::move(status);
 }
 
 Device::Type Device::type() const
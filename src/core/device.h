@@ -97,6 +97,7 @@ public:
 
     virtual SmartStatus& smartStatus();
     virtual const SmartStatus& smartStatus() const;
+    virtual void setSmartStatus(std::shared_ptr<SmartStatus> status);
 
     virtual Device::Type type() const;
 
@@ -9,6 +9,7 @@
 
 #include "core/device.h"
 
+#include <QMutex>
 #include <QString>
 
 #include <memory>
@@ -26,6 +27,7 @@ public:
     PartitionTable* m_PartitionTable;
     QString m_IconName;
     std::shared_ptr<SmartStatus> m_SmartStatus;
+    QMutex m_SmartStatusMutex; // guards m_SmartStatus, which is read on first use
     Device::Type m_Type;
 };
 
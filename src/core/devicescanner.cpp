@@ -14,6 +14,7 @@
 #include "core/operationstack.h"
 #include "core/device.h"
 #include "core/diskdevice.h"
+#include "core/usedspacereader.h"
 
 #include "fs/lvm2_pv.h"
 
@@ -26,7 +27,9 @@
 */
 DeviceScanner::DeviceScanner(QObject* parent, OperationStack& ostack) :
     QThread(parent),
-    m_OperationStack(ostack)
+    m_OperationStack(ostack),
+    m_ScanFlags(ScanFlag::includeLoopback),
+    m_UsedSpaceReader(new UsedSpaceReader(ostack, this))
 {
     setupConnections();
 }
@@ -34,10 +37,13 @@ DeviceScanner::DeviceScanner(QObject* parent, OperationStack& ostack) :
 void DeviceScanner::setupConnections()
 {
     connect(CoreBackendManager::self()->backend(), &CoreBackend::scanProgress, this, &DeviceScanner::progress);
+    connect(m_UsedSpaceReader, &UsedSpaceReader::sectorsUsedRead, this, &DeviceScanner::sectorsUsedRead);
+    connect(&operationStack(), &OperationStack::operationsChanged, m_UsedSpaceReader, &UsedSpaceReader::invalidate);
 }
 
 void DeviceScanner::clear()
 {
+    m_UsedSpaceReader->cancel();
     operationStack().clearOperations();
     operationStack().clearDevices();
 }
@@ -53,12 +59,21 @@ void DeviceScanner::scan()
 
     clear();
 
-    const QList<Device*> deviceList = CoreBackendManager::self()->backend()->scanDevices(ScanFlag::includeLoopback);
+    const bool deferUsedSpace = scanFlags().testFlag(ScanFlag::deferUsedSpace);
+    if (deferUsedSpace)
+        UsedSpaceReader::setCurrent(m_UsedSpaceReader);
+
+    const QList<Device*> deviceList = CoreBackendManager::self()->backend()->scanDevices(scanFlags());
 
     for (const auto &d : deviceList)
         operationStack().addDevice(d);
 
     operationStack().sortDevices();
+
+    if (deferUsedSpace) {
+        UsedSpaceReader::setCurrent(nullptr);
+        m_UsedSpaceReader->start();
+    }
 }
 
 
@@ -10,11 +10,14 @@
 #ifndef KPMCORE_DEVICESCANNER_H
 #define KPMCORE_DEVICESCANNER_H
 
+#include "backend/corebackend.h"
 #include "util/libpartitionmanagerexport.h"
 
 #include <QThread>
 
 class OperationStack;
+class Partition;
+class UsedSpaceReader;
 
 /** Thread to scan for all available Devices on this computer.
 
@@ -34,8 +37,17 @@ public:
     void scan(); /**< do the actual scanning; blocks if called directly */
     void setupConnections();
 
+    /** @return the flags passed to the backend when scanning, ScanFlag::includeLoopback by default */
+    ScanFlags scanFlags() const {
+        return m_ScanFlags;
+    }
+    void setScanFlags(ScanFlags flags) {
+        m_ScanFlags = flags;
+    }
+
 Q_SIGNALS:
     void progress(const QString& deviceNode, int progress);
+    void sectorsUsedRead(Partition* p); /**< used space of a file system arrived after a scan with ScanFlag::deferUsedSpace */
 
 protected:
     void run() override;
@@ -48,6 +60,8 @@ protected:
 
 private:
     OperationStack& m_OperationStack;
+    ScanFlags m_ScanFlags;
+    UsedSpaceReader* m_UsedSpaceReader;
 };
 
 #endif
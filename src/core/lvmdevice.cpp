@@ -8,8 +8,10 @@
 */
 
 #include "core/lvmdevice.h"
+#include "core/lvmreport.h"
 #include "core/partition.h"
 #include "core/partitiontable.h"
+#include "core/usedspacereader.h"
 #include "core/volumemanagerdevice_p.h"
 #include "fs/filesystem.h"
 #include "fs/lvm2_pv.h"
@@ -21,9 +23,11 @@
 #include "util/globallog.h"
 #include "util/report.h"
 
+#include <algorithm>
 #include <utility>
 
 #include <QRegularExpression>
+#include <QSet>
 #include <QStorageInfo>
 #include <QtMath>
 
@@ -31,6 +35,19 @@
 
 #define d_ptr std::static_pointer_cast<LvmDevicePrivate>(d)
 
+/** @return the position of @p lvPath in the sorted list @p lvPathList or the position to insert it at */
+static qsizetype lvPosition(const QStringList& lvPathList, const QString& lvPath)
+{
+    return std::lower_bound(lvPathList.cbegin(), lvPathList.cend(), lvPath) - lvPathList.cbegin();
+}
+
+/** @return the position of @p lvPath in the sorted list @p lvPathList or -1 if it is not in the list */
+static qsizetype lvIndex(const QStringList& lvPathList, const QString& lvPath)
+{
+    const qsizetype i = lvPosition(lvPathList, lvPath);
+    return i < lvPathList.size() && lvPathList[i] == lvPath ? i : -1;
+}
+
 class LvmDevicePrivate : public VolumeManagerDevicePrivate
 {
 public:
@@ -42,7 +59,16 @@ public:
 
     mutable QStringList m_LVPathList;
     QVector <const Partition*> m_PVs;
-    mutable std::unique_ptr<QHash<QString, qint64>> m_LVSizeMap;
+
+    /* m_LVPathList is sorted by path, the order of the LVs in the VG's abstract partition
+     * table (see PartitionTable::updateUnallocated()). m_LVSizes holds the size of each LV
+     * in that order and m_LVOffsets the prefix sums of m_LVSizes, i.e. the first sector of
+     * each LV. The offsets are extended lazily, so changing an LV only invalidates the
+     * offsets after it. */
+    mutable QList<qint64> m_LVSizes;
+    mutable QList<qint64> m_LVOffsets;
+
+    mutable QSet<QString> m_ActiveLVs;
 };
 
 /** Constructs a representation of LVM device with initialized LV as Partitions
@@ -65,7 +91,8 @@ LvmDevice::LvmDevice(const QString& vgName, const QString& iconName)
     d_ptr->m_allocPE = d_ptr->m_totalPE - d_ptr->m_freePE;
     d_ptr->m_UUID    = getUUID(vgName);
     d_ptr->m_LVPathList = getLVs(vgName);
-    d_ptr->m_LVSizeMap  = std::make_unique<QHash<QString, qint64>>();
+    d_ptr->m_LVPathList.sort();
+    d_ptr->m_LVSizes.fill(0, d_ptr->m_LVPathList.size());
 
     initPartitions();
 }
@@ -92,10 +119,10 @@ void LvmDevice::initPartitions()
     qint64 lastUsable  = totalPE() - 1;
     PartitionTable* pTable = new PartitionTable(PartitionTable::vmd, firstUsable, lastUsable);
 
-    for (const auto &p : scanPartitions(pTable)) {
-        LVSizeMap()->insert(p->partitionPath(), p->length());
+    activateLVs();
+
+    for (const auto &p : scanPartitions(pTable))
         pTable->append(p);
-    }
 
     if (pTable)
         pTable->updateUnallocated(*this);
@@ -137,9 +164,15 @@ const QList<Partition*> LvmDevice::scanPartitions(PartitionTable* pTable) const
  */
 Partition* LvmDevice::scanPartition(const QString& lvPath, PartitionTable* pTable) const
 {
-    activateLV(lvPath);
-
     qint64 lvSize = getTotalLE(lvPath);
+
+    // LVs are scanned in order, so all LVs before this one are known
+    const qsizetype index = lvIndex(d_ptr->m_LVPathList, lvPath);
+    if (index >= 0) {
+        d_ptr->m_LVSizes[index] = lvSize;
+        if (d_ptr->m_LVOffsets.size() > index + 1)
+            d_ptr->m_LVOffsets.resize(index + 1);
+    }
     qint64 startSector = mappedSector(lvPath, 0);
     qint64 endSector = startSector + lvSize - 1;
 
@@ -150,6 +183,7 @@ Partition* LvmDevice::scanPartition(const QString& lvPath, PartitionTable* pTabl
     PartitionRole::Roles r = PartitionRole::Lvm_Lv;
     QString mountPoint;
     bool mounted;
+    bool readUsedLater = false;
 
     // Handle LUKS partition
     if (fs->type() == FileSystem::Type::Luks) {
@@ -169,8 +203,12 @@ Partition* LvmDevice::scanPartition(const QString& lvPath, PartitionTable* pTabl
             if (logicalSize() > 0 && fs->type() != FileSystem::Type::Luks && mounted && storage.isValid())
                 fs->setSectorsUsed( (storage.bytesTotal() - storage.bytesFree()) / logicalSize() );
         }
-        else if (fs->supportGetUsed() == FileSystem::cmdSupportFileSystem)
-            fs->setSectorsUsed(qCeil(fs->readUsedCapacity(lvPath) / static_cast<double>(logicalSize())));
+        else if (fs->supportGetUsed() == FileSystem::cmdSupportFileSystem) {
+            if (UsedSpaceReader::current())
+                readUsedLater = true;
+            else
+                fs->setSectorsUsed(qCeil(fs->readUsedCapacity(lvPath) / static_cast<double>(logicalSize())));
+        }
    }
 
     if (fs->supportGetLabel() != FileSystem::cmdSupportNone) {
@@ -189,6 +227,10 @@ Partition* LvmDevice::scanPartition(const QString& lvPath, PartitionTable* pTabl
                     PartitionTable::Flag::None,
                     mountPoint,
                     mounted);
+
+    if (readUsedLater)
+        UsedSpaceReader::current()->enqueue(*part);
+
     return part;
 }
 
@@ -200,6 +242,11 @@ void LvmDevice::scanSystemLVM(QList<Device*>& devices)
 {
     LvmDevice::s_OrphanPVs.clear();
 
+    // Answer all vgs/pvs queries below from one lvm fullreport unless the caller already made one
+    std::unique_ptr<LvmReport> lvmReport;
+    if (!LvmReport::current())
+        lvmReport = std::make_unique<LvmReport>();
+
     QList<LvmDevice*> lvmList;
     for (const auto &vgName : getVGs()) {
         lvmList.append(new LvmDevice(vgName));
@@ -225,17 +272,52 @@ void LvmDevice::scanSystemLVM(QList<Device*>& devices)
 
 qint64 LvmDevice::mappedSector(const QString& lvPath, qint64 sector) const
 {
-    qint64 mSector = 0;
-    QStringList lvpathList = partitionNodes();
-    qint32 devIndex = lvpathList.indexOf(lvPath);
+    const qsizetype index = lvIndex(d_ptr->m_LVPathList, lvPath);
+    if (index < 0)
+        return sector;
 
-    if (devIndex) {
-        for (int i = 0; i < devIndex; i++) {
-            mSector += LVSizeMap()->value(lvpathList[i]);
-        }
-        mSector += sector;
+    // Extend the prefix sums up to this LV
+    QList<qint64>& offsets = d_ptr->m_LVOffsets;
+    if (offsets.isEmpty())
+        offsets.append(0);
+    while (offsets.size() <= index)
+        offsets.append(offsets.last() + d_ptr->m_LVSizes[offsets.size() - 1]);
+
+    return offsets[index] + sector;
+}
+
+/** Set the size of an LV, adding it at its position among the other LVs if it is not known yet.
+    @param lvPath LVM Logical Volume path
+    @param size size of the LV in extents
+*/
+void LvmDevice::setLVSize(const QString& lvPath, qint64 size)
+{
+    const qsizetype index = lvPosition(d_ptr->m_LVPathList, lvPath);
+    if (index < d_ptr->m_LVPathList.size() && d_ptr->m_LVPathList[index] == lvPath)
+        d_ptr->m_LVSizes[index] = size;
+    else {
+        d_ptr->m_LVPathList.insert(index, lvPath);
+        d_ptr->m_LVSizes.insert(index, size);
     }
-    return mSector;
+
+    if (d_ptr->m_LVOffsets.size() > index + 1)
+        d_ptr->m_LVOffsets.resize(index + 1);
+}
+
+/** Forget an LV that was removed.
+    @param lvPath LVM Logical Volume path
+*/
+void LvmDevice::removeLVSize(const QString& lvPath)
+{
+    const qsizetype index = lvIndex(d_ptr->m_LVPathList, lvPath);
+    if (index < 0)
+        return;
+
+    d_ptr->m_LVPathList.removeAt(index);
+    d_ptr->m_LVSizes.removeAt(index);
+
+    if (d_ptr->m_LVOffsets.size() > index + 1)
+        d_ptr->m_LVOffsets.resize(index + 1);
 }
 
 const QStringList LvmDevice::deviceNodes() const
@@ -258,7 +340,8 @@ const QStringList& LvmDevice::partitionNodes() const
 
 qint64 LvmDevice::partitionSize(QString& partitionPath) const
 {
-    return LVSizeMap()->value(partitionPath);
+    const qsizetype index = lvIndex(d_ptr->m_LVPathList, partitionPath);
+    return index < 0 ? 0 : d_ptr->m_LVSizes[index];
 }
 
 const QStringList LvmDevice::getVGs()
@@ -327,6 +410,9 @@ QString LvmDevice::getUUID(const QString& vgName)
 
 QString LvmDevice::getField(const QString& fieldName, const QString& vgName)
 {
+    if (const LvmReport* report = LvmReport::current(); report && report->isValid())
+        return report->vgField(fieldName, vgName);
+
     QStringList args = { QStringLiteral("vgs"),
               QStringLiteral("--foreign"),
               QStringLiteral("--readonly"),
@@ -348,6 +434,12 @@ QString LvmDevice::getField(const QString& fieldName, const QString& vgName)
 
 qint64 LvmDevice::getTotalLE(const QString& lvPath)
 {
+    if (const LvmReport* report = LvmReport::current(); report && report->isValid()) {
+        const qint64 extents = report->lvExtentCount(lvPath);
+        if (extents >= 0)
+            return extents;
+    }
+
     ExternalCommand cmd(QStringLiteral("lvm"),
             { QStringLiteral("lvdisplay"),
               lvPath});
@@ -371,6 +463,7 @@ bool LvmDevice::removeLV(Report& report, LvmDevice& d, Partition& p)
               p.partitionPath()});
 
     if (cmd.run(-1) && cmd.exitCode() == 0) {
+        d.removeLVSize(p.partitionPath());
         d.partitionTable()->remove(&p);
         return  true;
     }
@@ -388,7 +481,11 @@ bool LvmDevice::createLV(Report& report, LvmDevice& d, Partition& p, const QStri
               lvName,
               d.name()});
 
-    return (cmd.run(-1) && cmd.exitCode() == 0);
+    if (!cmd.run(-1) || cmd.exitCode() != 0)
+        return false;
+
+    d.setLVSize(p.partitionPath(), p.length());
+    return true;
 }
 
 bool LvmDevice::createLVSnapshot(Report& report, Partition& p, const QString& name, const qint64 extents)
@@ -488,7 +585,12 @@ bool LvmDevice::deactivateVG(Report& report, const LvmDevice& d)
             { QStringLiteral("vgchange"),
               QStringLiteral("--activate"), QStringLiteral("n"),
               d.name() });
-    return deactivate.run(-1) && deactivate.exitCode() == 0;
+    if (!deactivate.run(-1) || deactivate.exitCode() != 0)
+        return false;
+
+    for (const auto &lvPath : d.partitionNodes())
+        d.setLVActive(lvPath, false);
+    return true;
 }
 
 bool LvmDevice::deactivateLV(Report& report, const Partition& p)
@@ -497,7 +599,7 @@ bool LvmDevice::deactivateLV(Report& report, const Partition& p)
             { QStringLiteral("lvchange"),
               QStringLiteral("--activate"), QStringLiteral("n"),
               p.partitionPath() });
-    return deactivate.run(-1) && deactivate.exitCode() == 0;
+    return deactivate.run() && deactivate.exitCode() == 0;
 }
 
 bool LvmDevice::activateVG(Report& report, const LvmDevice& d)
@@ -506,7 +608,65 @@ bool LvmDevice::activateVG(Report& report, const LvmDevice& d)
             { QStringLiteral("vgchange"),
               QStringLiteral("--activate"), QStringLiteral("y"),
               d.name() });
-    return deactivate.run(-1) && deactivate.exitCode() == 0;
+    if (!deactivate.run(-1) || deactivate.exitCode() != 0)
+        return false;
+
+    for (const auto &lvPath : d.partitionNodes())
+        d.setLVActive(lvPath, true);
+    return true;
+}
+
+/** Activate all LVs of this VG that are not active yet with a single vgchange.
+
+    The activation state is taken from the LVM report of the running scan, without
+    one all LVs are activated. LVs that could not be activated together are
+    activated one by one.
+*/
+void LvmDevice::activateLVs() const
+{
+    const LvmReport* report = LvmReport::current();
+    if (report && !report->isValid())
+        report = nullptr;
+
+    QStringList inactive;
+    for (const auto &lvPath : partitionNodes()) {
+        if (report && !report->lvField(QStringLiteral("lv_active"), lvPath).isEmpty())
+            d_ptr->m_ActiveLVs.insert(lvPath);
+        else if (!isLVActive(lvPath))
+            inactive.append(lvPath);
+    }
+
+    if (inactive.isEmpty())
+        return;
+
+    // One vgchange activates all LVs of the VG, its command line does not grow with
+    // the number of LVs. ExternalCommand::run() ignores its timeout, runCommands()
+    // lets the helper kill a vgchange that hangs, e.g. on a missing PV.
+    const QList<QVariantMap> results = ExternalCommand().runCommands({ { QStringLiteral("lvm"),
+            QStringLiteral("vgchange"), QStringLiteral("--activate"), QStringLiteral("y"), name() } }, 1, 120000);
+    if (!results.isEmpty() && results.first()[QStringLiteral("success")].toBool() && results.first()[QStringLiteral("exitCode")].toInt() == 0) {
+        for (const auto &lvPath : std::as_const(inactive))
+            setLVActive(lvPath, true);
+        return;
+    }
+
+    for (const auto &lvPath : std::as_const(inactive))
+        if (activateLV(lvPath))
+            setLVActive(lvPath, true);
+}
+
+/** @return true if the LV at lvPath is known to be active */
+bool LvmDevice::isLVActive(const QString& lvPath) const
+{
+    return d_ptr->m_ActiveLVs.contains(lvPath);
+}
+
+void LvmDevice::setLVActive(const QString& lvPath, bool active) const
+{
+    if (active)
+        d_ptr->m_ActiveLVs.insert(lvPath);
+    else
+        d_ptr->m_ActiveLVs.remove(lvPath);
 }
 
 bool LvmDevice::activateLV(const QString& lvPath)
@@ -515,7 +675,7 @@ bool LvmDevice::activateLV(const QString& lvPath)
             { QStringLiteral("lvchange"),
               QStringLiteral("--activate"), QStringLiteral("y"),
               lvPath });
-    return deactivate.run(-1) && deactivate.exitCode() == 0;
+    return deactivate.run() && deactivate.exitCode() == 0;
 }
 
 qint64 LvmDevice::peSize() const
@@ -558,8 +718,3 @@ const QVector <const Partition*>& LvmDevice::physicalVolumes() const
 {
     return d_ptr->m_PVs;
 }
-
-std::unique_ptr<QHash<QString, qint64>>& LvmDevice::LVSizeMap() const
-{
-    return d_ptr->m_LVSizeMap;
-}
@@ -36,6 +36,7 @@ class LIBKPMCORE_EXPORT LvmDevice : public VolumeManagerDevice
     Q_DISABLE_COPY(LvmDevice)
 
     friend class VolumeManagerDevice;
+    friend class SetPartGeometryJob;
 
 public:
     explicit LvmDevice(const QString& name, const QString& iconName = QString());
@@ -81,6 +82,7 @@ protected:
     void initPartitions() override;
     const QList<Partition*> scanPartitions(PartitionTable* pTable) const;
     Partition* scanPartition(const QString& lvPath, PartitionTable* pTable) const;
+    void activateLVs() const;
     qint64 mappedSector(const QString& lvPath, qint64 sector) const override;
 
 public:
@@ -89,15 +91,16 @@ public:
     qint64 allocatedPE() const;
     qint64 freePE() const;
     void setFreePE(qint64 freePE) const;
+    bool isLVActive(const QString& lvPath) const;
+    void setLVActive(const QString& lvPath, bool active) const;
     QString UUID() const;
     QVector <const Partition*>& physicalVolumes();
     const QVector <const Partition*>& physicalVolumes() const;
 
-protected:
-    std::unique_ptr<QHash<QString, qint64>>& LVSizeMap() const;
-
 private:
     static void scanSystemLVM(QList<Device*>& devices);
+    void setLVSize(const QString& lvPath, qint64 size);
+    void removeLVSize(const QString& lvPath);
 };
 
 #endif
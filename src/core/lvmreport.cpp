@@ -0,0 +1,212 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "core/lvmreport.h"
+
+#include "util/externalcommand.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+using namespace Qt::StringLiterals;
+
+static thread_local const LvmReport* currentReport = nullptr;
+
+/** Creates an empty report and makes it the current one for the calling thread.
+
+    lvm is not run before the report is queried for the first time, so creating a
+    report is cheap on systems without LVM.
+*/
+LvmReport::LvmReport() :
+    m_Loaded(false),
+    m_Valid(false),
+    m_Previous(currentReport)
+{
+    currentReport = this;
+}
+
+LvmReport::~LvmReport()
+{
+    currentReport = m_Previous;
+}
+
+/** @return the report of the scan running in this thread or nullptr if there is none */
+const LvmReport* LvmReport::current()
+{
+    return currentReport;
+}
+
+/** @return true if lvm fullreport could be run and parsed */
+bool LvmReport::isValid() const
+{
+    load();
+    return m_Valid;
+}
+
+/** Get a field of a Volume Group like "lvm vgs --options fieldName vgName" would.
+
+    Fields of Logical Volumes (lv_*) return one line per LV of the VG and an empty
+    vgName returns one line per VG.
+
+    @param fieldName LVM field name
+    @param vgName the name of LVM Volume Group
+    @return the field value(s) or an empty string if the VG or field is unknown
+*/
+QString LvmReport::vgField(const QString& fieldName, const QString& vgName) const
+{
+    load();
+
+    QStringList values;
+    const QStringList vgNames = vgName.isEmpty() ? m_VGs.keys() : QStringList { vgName };
+    for (const QString& name : vgNames) {
+        if (fieldName.startsWith(u"lv_"_s)) {
+            for (const QJsonObject& lv : m_LVs.value(name))
+                values.append(lv.value(fieldName).toString());
+        }
+        else if (m_VGs.contains(name))
+            values.append(m_VGs.value(name).value(fieldName).toString());
+    }
+
+    return values.join(QLatin1Char('\n')).trimmed();
+}
+
+/** Get a field of a Physical Volume like "lvm pvs --options fieldName deviceNode" would.
+    @param fieldName LVM field name, fields of the VG the PV belongs to can be used too
+    @param deviceNode the device node of the PV
+    @return the field value or an empty string if deviceNode is not a PV
+*/
+QString LvmReport::pvField(const QString& fieldName, const QString& deviceNode) const
+{
+    return physicalVolume(deviceNode).value(fieldName).toString().trimmed();
+}
+
+/** @return true if deviceNode is a Physical Volume known to LVM */
+bool LvmReport::containsPV(const QString& deviceNode) const
+{
+    return !physicalVolume(deviceNode).isEmpty();
+}
+
+QJsonObject LvmReport::physicalVolume(const QString& deviceNode) const
+{
+    load();
+
+    const quint64 dev = deviceNumber(deviceNode);
+    return dev && m_PVsByDevice.contains(dev) ? m_PVsByDevice.value(dev) : m_PVsByName.value(deviceNode);
+}
+
+/** Get a field of a Logical Volume like "lvm lvs --options fieldName lvPath" would.
+    @param fieldName LVM field name, fields of the VG the LV belongs to can be used too
+    @param lvPath LVM Logical Volume path
+    @return the field value or an empty string if the LV is unknown
+*/
+QString LvmReport::lvField(const QString& fieldName, const QString& lvPath) const
+{
+    load();
+
+    return m_LVsByPath.value(lvPath).value(fieldName).toString().trimmed();
+}
+
+/** @return the number of extents of the Logical Volume at lvPath or -1 if it is unknown */
+qint64 LvmReport::lvExtentCount(const QString& lvPath) const
+{
+    const qint64 extentSize = lvField(u"vg_extent_size"_s, lvPath).toLongLong();
+    return extentSize > 0 ? lvField(u"lv_size"_s, lvPath).toLongLong() / extentSize : -1;
+}
+
+/* The output looks like
+ *   {"report": [ {"vg": [{...}], "pv": [{...}, ...], "lv": [{...}, ...], "pvseg": [...], "seg": [...]}, ... ]}
+ * with one element per VG and all values as strings.
+ */
+void LvmReport::load() const
+{
+    if (m_Loaded)
+        return;
+    m_Loaded = true;
+
+    ExternalCommand cmd(u"lvm"_s,
+            { u"fullreport"_s,
+              u"--foreign"_s,
+              u"--readonly"_s,
+              u"--reportformat"_s, u"json"_s,
+              u"--units"_s, u"B"_s,
+              u"--nosuffix"_s,
+              u"--configreport"_s, u"vg"_s, u"--options"_s, u"vg_name,vg_uuid,vg_extent_size,vg_extent_count,vg_free_count"_s,
+              u"--configreport"_s, u"pv"_s, u"--options"_s, u"pv_name,pv_uuid,pv_used,pe_start,pv_pe_count,pv_pe_alloc_count"_s,
+              u"--configreport"_s, u"lv"_s, u"--options"_s, u"lv_path,lv_size,lv_active"_s,
+              u"--configreport"_s, u"pvseg"_s, u"--options"_s, u"pvseg_start"_s,
+              u"--configreport"_s, u"seg"_s, u"--options"_s, u"segtype"_s },
+            QProcess::ProcessChannelMode::SeparateChannels);
+    if (!cmd.run(-1) || cmd.exitCode() != 0)
+        return;
+
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(cmd.rawOutput(), &error);
+    if (error.error != QJsonParseError::NoError || !document.isObject())
+        return;
+
+    const QJsonArray report = document.object().value(u"report"_s).toArray();
+    for (const QJsonValue& item : report) {
+        const QJsonObject group = item.toObject();
+
+        // Orphan PVs are reported in a group without a VG
+        QJsonObject vg;
+        const QJsonArray vgs = group.value(u"vg"_s).toArray();
+        if (!vgs.isEmpty())
+            vg = vgs.first().toObject();
+        const QString vgName = vg.value(u"vg_name"_s).toString().trimmed();
+        if (!vgName.isEmpty())
+            m_VGs.insert(vgName, vg);
+
+        const QJsonArray pvs = group.value(u"pv"_s).toArray();
+        for (const QJsonValue& value : pvs) {
+            QJsonObject pv = vg;
+            const QJsonObject pvFields = value.toObject();
+            for (auto it = pvFields.begin(); it != pvFields.end(); ++it)
+                pv.insert(it.key(), it.value());
+
+            const QString pvName = pv.value(u"pv_name"_s).toString().trimmed();
+            if (pvName.isEmpty())
+                continue;
+            m_PVsByName.insert(pvName, pv);
+            if (const quint64 dev = deviceNumber(pvName))
+                m_PVsByDevice.insert(dev, pv);
+        }
+
+        const QJsonArray lvs = group.value(u"lv"_s).toArray();
+        for (const QJsonValue& value : lvs) {
+            QJsonObject lv = vg;
+            const QJsonObject lvFields = value.toObject();
+            for (auto it = lvFields.begin(); it != lvFields.end(); ++it)
+                lv.insert(it.key(), it.value());
+
+            // Hidden LVs have no path, vgs does not list them either
+            const QString lvPath = lv.value(u"lv_path"_s).toString().trimmed();
+            if (lvPath.isEmpty())
+                continue;
+            m_LVs[vgName].append(lv);
+            m_LVsByPath.insert(lvPath, lv);
+        }
+    }
+
+    m_Valid = true;
+}
+
+/** @return the device number of a block device node or 0 if it is not one */
+quint64 LvmReport::deviceNumber(const QString& deviceNode)
+{
+    if (deviceNode.isEmpty())
+        return 0;
+
+    struct stat st;
+    if (stat(QFile::encodeName(deviceNode).constData(), &st) != 0 || !S_ISBLK(st.st_mode))
+        return 0;
+
+    return st.st_rdev;
+}
@@ -0,0 +1,65 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_LVMREPORT_H
+#define KPMCORE_LVMREPORT_H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include <QHash>
+#include <QJsonObject>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+
+/** Snapshot of the LVM configuration of the system.
+
+    Runs a single "lvm fullreport" the first time it is queried and answers all
+    questions about volume groups, physical volumes and logical volumes from it,
+    instead of running vgs, pvs and lvdisplay for every field of every object.
+
+    A report is meant to live for the duration of a scan. While it exists it is
+    returned by current() for the thread that created it and used by
+    LvmDevice::getField(), LvmDevice::getTotalLE() and FS::lvm2_pv::getpvField().
+
+    @author kpmcore contributors
+*/
+class LIBKPMCORE_EXPORT LvmReport
+{
+    Q_DISABLE_COPY(LvmReport)
+
+public:
+    LvmReport();
+    ~LvmReport();
+
+public:
+    bool isValid() const;
+
+    QString vgField(const QString& fieldName, const QString& vgName = QString()) const;
+    bool containsPV(const QString& deviceNode) const;
+    QString pvField(const QString& fieldName, const QString& deviceNode) const;
+    QString lvField(const QString& fieldName, const QString& lvPath) const;
+    qint64 lvExtentCount(const QString& lvPath) const;
+
+    static const LvmReport* current();
+
+private:
+    void load() const;
+    QJsonObject physicalVolume(const QString& deviceNode) const;
+    static quint64 deviceNumber(const QString& deviceNode);
+
+private:
+    mutable bool m_Loaded;
+    mutable bool m_Valid;
+    mutable QMap<QString, QJsonObject> m_VGs;           /**< VGs by name, sorted like vgs output */
+    mutable QHash<QString, QList<QJsonObject>> m_LVs;   /**< LVs of each VG, with the fields of their VG */
+    mutable QHash<QString, QJsonObject> m_LVsByPath;
+    mutable QHash<QString, QJsonObject> m_PVsByName;    /**< PVs with the fields of their VG */
+    mutable QHash<quint64, QJsonObject> m_PVsByDevice;
+    const LvmReport* m_Previous;
+};
+
+#endif
@@ -0,0 +1,165 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "core/mountindex.h"
+#include "core/fstab.h"
+
+#include <QFile>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#if defined(Q_OS_LINUX)
+    #include <sys/sysmacros.h>
+#endif
+
+static thread_local const MountIndex* currentIndex = nullptr;
+
+/** The kernel escapes space, tab, newline and backslash in mountinfo and swaps as \ooo.
+    @return @p field with every octal escape decoded
+*/
+static QString unescapeOctal(const QByteArray& field)
+{
+    QByteArray result;
+    result.reserve(field.size());
+
+    auto isOctal = [] (char c) { return c >= '0' && c <= '7'; };
+
+    for (qsizetype i = 0; i < field.size(); ++i) {
+        if (field[i] == '\\' && i + 3 < field.size() &&
+                isOctal(field[i + 1]) && isOctal(field[i + 2]) && isOctal(field[i + 3])) {
+            result.append(static_cast<char>((field[i + 1] - '0') * 64 + (field[i + 2] - '0') * 8 + (field[i + 3] - '0')));
+            i += 3;
+        }
+        else
+            result.append(field[i]);
+    }
+
+    return QFile::decodeName(result);
+}
+
+/** Builds the index and makes it the current one for the calling thread.
+    @param fstabPath path to the fstab file
+*/
+MountIndex::MountIndex(const QString& fstabPath) :
+    m_Valid(false),
+    m_Previous(currentIndex)
+{
+    readMountInfo();
+    if (m_Valid) {
+        readSwaps();
+        readFstab(fstabPath);
+    }
+
+    currentIndex = this;
+}
+
+MountIndex::~MountIndex()
+{
+    currentIndex = m_Previous;
+}
+
+/** @return the index of the scan running in this thread or nullptr if there is none */
+const MountIndex* MountIndex::current()
+{
+    return currentIndex && currentIndex->isValid() ? currentIndex : nullptr;
+}
+
+QStringList MountIndex::mountPoints(const QString& deviceNode) const
+{
+    const quint64 dev = deviceNumber(deviceNode);
+    return dev ? m_MountPoints.value(dev) : QStringList();
+}
+
+QStringList MountIndex::fstabMountPoints(const QString& deviceNode) const
+{
+    const quint64 dev = deviceNumber(deviceNode);
+    return dev ? m_FstabMountPoints.value(dev) : QStringList();
+}
+
+bool MountIndex::isMounted(const QString& deviceNode) const
+{
+    const quint64 dev = deviceNumber(deviceNode);
+    return dev && (m_MountPoints.contains(dev) || m_Swaps.contains(dev));
+}
+
+/** @return the device number of a block device node or 0 if it is not one */
+quint64 MountIndex::deviceNumber(const QString& deviceNode)
+{
+    if (deviceNode.isEmpty())
+        return 0;
+
+    struct stat st;
+    if (stat(QFile::encodeName(deviceNode).constData(), &st) != 0 || !S_ISBLK(st.st_mode))
+        return 0;
+
+    return st.st_rdev;
+}
+
+/* Each line of mountinfo looks like
+ *   36 35 98:0 /mnt1 /mnt2 rw,noatime master:1 - ext3 /dev/root rw,errors=continue
+ * with a variable number of optional fields before the "-" separator.
+ */
+void MountIndex::readMountInfo()
+{
+#if defined(Q_OS_LINUX)
+    QFile mountInfo(QStringLiteral("/proc/self/mountinfo"));
+    if (!mountInfo.open(QIODevice::ReadOnly))
+        return;
+
+    const QList<QByteArray> lines = mountInfo.readAll().split('\n');
+    for (const QByteArray& line : lines) {
+        const QList<QByteArray> fields = line.split(' ');
+        const qsizetype separator = fields.indexOf(QByteArrayLiteral("-"));
+        if (fields.size() < 5 || separator < 0 || fields.size() < separator + 3)
+            continue;
+
+        const QList<QByteArray> majorMinor = fields[2].split(':');
+        if (majorMinor.size() != 2)
+            continue;
+
+        quint64 dev = makedev(majorMinor[0].toUInt(), majorMinor[1].toUInt());
+
+        // Some file systems (e.g. btrfs) report an anonymous device number, use the mount source instead
+        if (major(dev) == 0) {
+            const QString source = unescapeOctal(fields[separator + 2]);
+            if (!source.startsWith(QLatin1Char('/')))
+                continue;
+            dev = deviceNumber(source);
+            if (dev == 0)
+                continue;
+        }
+
+        m_MountPoints[dev].append(unescapeOctal(fields[4]));
+    }
+
+    m_Valid = true;
+#endif
+}
+
+void MountIndex::readSwaps()
+{
+    QFile swaps(QStringLiteral("/proc/swaps"));
+    if (!swaps.open(QIODevice::ReadOnly))
+        return;
+
+    const QList<QByteArray> lines = swaps.readAll().split('\n');
+    for (qsizetype i = 1; i < lines.size(); ++i) { // first line is the header
+        const QByteArray fileName = lines[i].split(' ').first();
+        if (fileName.isEmpty())
+            continue;
+        if (const quint64 dev = deviceNumber(unescapeOctal(fileName)))
+            m_Swaps.insert(dev);
+    }
+}
+
+void MountIndex::readFstab(const QString& fstabPath)
+{
+    const FstabEntryList fstabEntryList = readFstabEntries(fstabPath);
+    for (const FstabEntry& entry : fstabEntryList) {
+        if (const quint64 dev = deviceNumber(entry.deviceNode()))
+            m_FstabMountPoints[dev].append(entry.mountPoint());
+    }
+}
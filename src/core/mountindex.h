@@ -0,0 +1,65 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_MOUNTINDEX_H
+#define KPMCORE_MOUNTINDEX_H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+/** Index of mounted and configured file systems.
+
+    Reads /proc/self/mountinfo, /proc/swaps and /etc/fstab once and indexes their
+    entries by the device number (major:minor) of the block device, so looking up a
+    partition needs a single stat() instead of rereading and canonicalizing the
+    whole mount table and fstab.
+
+    An index is meant to live for the duration of a scan. While it exists it is
+    returned by current() for the thread that created it and used by
+    FileSystem::detectMountPoint() and FileSystem::detectMountStatus().
+
+    @author kpmcore contributors
+*/
+class LIBKPMCORE_EXPORT MountIndex
+{
+    Q_DISABLE_COPY(MountIndex)
+
+public:
+    explicit MountIndex(const QString& fstabPath = QStringLiteral("/etc/fstab"));
+    ~MountIndex();
+
+public:
+    /** @return false if the mount table could not be read, e.g. on systems without procfs */
+    bool isValid() const {
+        return m_Valid;
+    }
+
+    QStringList mountPoints(const QString& deviceNode) const; /**< @return where the device is mounted now */
+    QStringList fstabMountPoints(const QString& deviceNode) const; /**< @return mount points of the device in fstab */
+    bool isMounted(const QString& deviceNode) const; /**< @return true if the device is mounted or an active swap */
+
+    static const MountIndex* current();
+
+private:
+    void readMountInfo();
+    void readSwaps();
+    void readFstab(const QString& fstabPath);
+
+    static quint64 deviceNumber(const QString& deviceNode);
+
+private:
+    bool m_Valid;
+    QHash<quint64, QStringList> m_MountPoints;
+    QHash<quint64, QStringList> m_FstabMountPoints;
+    QSet<quint64> m_Swaps;
+    const MountIndex* m_Previous;
+};
+
+#endif
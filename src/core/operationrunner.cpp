@@ -8,13 +8,21 @@
 
 #include "core/operationrunner.h"
 #include "core/operationstack.h"
+#include "core/device.h"
+#include "core/raid/raidmonitor.h"
+#include "backend/commitbatch.h"
 #include "ops/operation.h"
+#include "util/lvmshell.h"
 #include "util/report.h"
 
 #include <QDBusInterface>
 #include <QDBusReply>
 #include <QMutex>
 
+#include <KLocalizedString>
+
+#include <memory>
+
 /** Constructs an OperationRunner.
     @param ostack the OperationStack to act on
 */
@@ -49,15 +57,32 @@ void OperationRunner::run()
     if (automounter)
         kdedInterface.call( QStringLiteral("unloadModule"), automounterService );
 
+    // Run all LVM commands of this batch in one lvm process
+    auto lvmShell = std::make_unique<LvmShell>();
+
+    // Tell the kernel and udev about changed partition tables once per device
+    auto commits = std::make_unique<CommitBatch>();
+
+    // Watch the arrays so operations on them do not compete with a resync for bandwidth
+    RaidMonitor raidMonitor;
+    for (const auto &d : operationStack().previewDevices())
+        if (d->type() == Device::Type::SoftwareRAID_Device)
+            raidMonitor.watch(d->deviceNode());
+    raidMonitor.start();
+
     for (int i = 0; i < numOperations(); i++) {
         suspendMutex().lock();
         suspendMutex().unlock();
 
+        Operation* op = operationStack().operations()[i];
+
+        if (status)
+            waitForRaidSync(raidMonitor, *op);
+
         if (!status || isCancelling()) {
             break;
         }
 
-        Operation* op = operationStack().operations()[i];
         op->setStatus(Operation::StatusRunning);
 
         Q_EMIT opStarted(i + 1, op);
@@ -72,6 +97,11 @@ void OperationRunner::run()
         Q_EMIT opFinished(i + 1, op);
     }
 
+    if (!CommitBatch::flush(report()))
+        status = false;
+    commits.reset();
+    lvmShell.reset();
+
     if (automounter)
         kdedInterface.call( QStringLiteral("loadModule"), automounterService );
 
@@ -83,6 +113,23 @@ void OperationRunner::run()
         Q_EMIT finished();
 }
 
+/** Waits until the arrays an Operation targets are done with any resync, recovery or reshape.
+    @param raidMonitor the monitor watching the arrays
+    @param op the Operation about to run
+*/
+void OperationRunner::waitForRaidSync(const RaidMonitor& raidMonitor, const Operation& op)
+{
+    for (const auto &d : operationStack().previewDevices()) {
+        if (d->type() != Device::Type::SoftwareRAID_Device || !op.targets(*d) || !raidMonitor.isSyncing(d->deviceNode()))
+            continue;
+
+        report().line() << xi18nc("@info:status", "Waiting for the resync of <filename>%1</filename> to finish.", d->deviceNode());
+
+        while (raidMonitor.isSyncing(d->deviceNode()) && !isCancelling())
+            msleep(1000);
+    }
+}
+
 /** @return the number of Operations to run */
 qint32 OperationRunner::numOperations() const
 {
@@ -17,6 +17,7 @@
 
 class Operation;
 class OperationStack;
+class RaidMonitor;
 class Report;
 
 /** Thread to run the Operations in the OperationStack.
@@ -74,6 +75,7 @@ protected:
         Q_ASSERT(m_Report);
         return *m_Report;
     }
+    void waitForRaidSync(const RaidMonitor& raidMonitor, const Operation& op);
 
 private:
     OperationStack& m_OperationStack;
@@ -33,14 +33,20 @@
 
 #include <KLocalizedString>
 
+#include <QMutexLocker>
 #include <QReadLocker>
 #include <QWriteLocker>
 
+#include <algorithm>
+
 /** Constructs a new OperationStack */
 OperationStack::OperationStack(QObject* parent) :
     QObject(parent),
     m_Operations(),
     m_PreviewDevices(),
+    m_DeviceIndex(),
+    m_OperationIndex(),
+    m_OperationIndexMutex(),
     m_Lock(QReadWriteLock::Recursive)
 {
 }
@@ -194,6 +200,62 @@ bool OperationStack::mergeNewOperation(Operation*& currentOp, Operation*& pushed
     return false;
 }
 
+/** Tries to merge an existing ResizeOperation with a new Operation pushed on the OperationStack.
+
+    If a Partition is resized or moved again, both ResizeOperations are replaced by one that
+    takes the Partition from its original to its final geometry, so its data is moved only
+    once. If the Partition ends up where it was, no Operation is left at all.
+
+    This is only done if no other Operation on the Device or the Partition was pushed in
+    between, as these may depend on the intermediate geometry, e.g. by growing another
+    Partition into the space the first ResizeOperation freed or by copying the Partition.
+
+    @param currentOp the Operation already on the stack to try to merge with
+    @param pushedOp the newly pushed Operation
+    @return true if the OperationStack has been modified in a way that requires merging to stop
+*/
+bool OperationStack::mergeResizeOperation(Operation*& currentOp, Operation*& pushedOp)
+{
+    ResizeOperation* resizeOp = dynamic_cast<ResizeOperation*>(currentOp);
+
+    if (resizeOp == nullptr)
+        return false;
+
+    ResizeOperation* pushedResizeOp = dynamic_cast<ResizeOperation*>(pushedOp);
+
+    if (pushedResizeOp == nullptr || &resizeOp->partition() != &pushedResizeOp->partition())
+        return false;
+
+    for (qsizetype i = operations().indexOf(resizeOp) + 1; i < operations().size(); i++)
+        if (operations().at(i)->targets(resizeOp->targetDevice()))
+            return false;
+
+    // Operations on other devices may still use the partition, e.g. copy it
+    const Operations partitionOps = operationsFor(&resizeOp->partition());
+    if (!partitionOps.isEmpty() && partitionOps.last() != resizeOp)
+        return false;
+
+    Log() << xi18nc("@info:status", "Resizing or moving a partition again: Merging with the previous operation.");
+
+    Device& device = resizeOp->targetDevice();
+    Partition& partition = resizeOp->partition();
+    const qint64 newFirstSector = pushedResizeOp->newFirstSector();
+    const qint64 newLastSector = pushedResizeOp->newLastSector();
+
+    delete pushedOp;
+    pushedOp = nullptr;
+
+    resizeOp->undo();
+    delete operations().takeAt(operations().indexOf(resizeOp));
+
+    if (partition.firstSector() != newFirstSector || partition.lastSector() != newLastSector)
+        pushedOp = new ResizeOperation(device, partition, newFirstSector, newLastSector);
+    else
+        Log() << xi18nc("@info:status", "Partition is back at its original position and size: No operation required.");
+
+    return true;
+}
+
 /** Tries to merge an existing CopyOperation with a new Operation pushed on the OperationStack.
 
     These are the cases to consider:
@@ -420,6 +482,9 @@ void OperationStack::push(Operation* o)
         if (mergeNewOperation(*currentOp, o))
             break;
 
+        if (mergeResizeOperation(*currentOp, o))
+            break;
+
         if (mergeCopyOperation(*currentOp, o))
             break;
 
@@ -443,6 +508,9 @@ void OperationStack::push(Operation* o)
         o->setStatus(Operation::StatusPending);
     }
 
+    rebuildDeviceIndex();
+    clearOperationIndex();
+
     // Q_EMIT operationsChanged even if o is nullptr because it has been merged: merging might
     // have led to an existing operation changing.
     Q_EMIT operationsChanged();
@@ -454,6 +522,9 @@ void OperationStack::pop()
     Operation* o = operations().takeLast();
     o->undo();
     delete o;
+
+    rebuildDeviceIndex();
+    clearOperationIndex();
     Q_EMIT operationsChanged();
 }
 
@@ -462,22 +533,57 @@ void OperationStack::pop()
     @param p Pointer to the Partition. Must not be nullptr.
 */
 bool OperationStack::contains(const Partition* p) const
+{
+    return !operationsFor(p).isEmpty();
+}
+
+/** Finds the Operations that involve a Partition.
+
+    The result is remembered until the next Operation is pushed or popped, so asking
+    again for the same Partition does not go through all Operations. Unallocated
+    Partitions are not remembered: PartitionTable::updateUnallocated() deletes and
+    creates them anew, so their addresses are reused by other Partitions.
+
+    @param p Pointer to the Partition. Must not be nullptr.
+    @return the Operations that target @p p or copy from it
+*/
+OperationStack::Operations OperationStack::operationsFor(const Partition* p) const
 {
     Q_ASSERT(p);
 
+    // Called by readers of the stack holding only a read lock
+    QMutexLocker locker(&m_OperationIndexMutex);
+
+    auto it = m_OperationIndex.constFind(p);
+    if (it != m_OperationIndex.cend())
+        return *it;
+
+    Operations result;
     for (const auto &o : operations()) {
-        if (o->targets(*p))
-            return true;
+        if (o->targets(*p)) {
+            result.append(o);
+            continue;
+        }
 
         CopyOperation* copyOp = dynamic_cast<CopyOperation*>(o);
         if (copyOp) {
             const Partition* source = &copyOp->sourcePartition();
             if (source == p)
-                return true;
+                result.append(o);
         }
     }
 
-    return false;
+    if (!p->roles().has(PartitionRole::Unallocated))
+        m_OperationIndex.insert(p, result);
+
+    return result;
+}
+
+/** Forgets the remembered results of operationsFor(). */
+void OperationStack::clearOperationIndex()
+{
+    QMutexLocker locker(&m_OperationIndexMutex);
+    m_OperationIndex.clear();
 }
 
 /** Removes all Operations from the OperationStack, calling Operation::undo() on them and deleting them. */
@@ -490,6 +596,8 @@ void OperationStack::clearOperations()
         delete o;
     }
 
+    rebuildDeviceIndex();
+    clearOperationIndex();
     Q_EMIT operationsChanged();
 }
 
@@ -500,9 +608,25 @@ void OperationStack::clearDevices()
 
     qDeleteAll(previewDevices());
     previewDevices().clear();
+    m_DeviceIndex.clear();
+    clearOperationIndex();
     Q_EMIT devicesChanged();
 }
 
+/** @return true if @p p is in @p table and not just has it as its root */
+static bool isInTable(const PartitionTable& table, const Partition* p)
+{
+    if (table.findPartitionBySector(p->firstSector(), PartitionRole(PartitionRole::Any)) == p)
+        return true;
+
+    // Partitions overlap for a moment while a preview partition is inserted
+    for (const PartitionNode* node = p; !node->isRoot(); node = node->parent())
+        if (!node->parent()->children().contains(static_cast<Partition*>(const_cast<PartitionNode*>(node))))
+            return false;
+
+    return true;
+}
+
 /** Finds a Device a Partition is on.
     @param p pointer to the Partition to find a Device for
     @return the Device or nullptr if none could be found
@@ -511,23 +635,40 @@ Device* OperationStack::findDeviceForPartition(const Partition* p)
 {
     QReadLocker lockDevices(&lock());
 
-    const auto devices = previewDevices();
-    for (Device *d : devices) {
-        if (d->partitionTable() == nullptr)
-            continue;
+    const PartitionNode* root = p;
+    while (root->parent() != nullptr && !root->isRoot())
+        root = root->parent();
 
-        const auto partitions = d->partitionTable()->children();
-        for (const auto *part : partitions) {
-            if (part == p)
-                return d;
+    if (!root->isRoot())
+        return nullptr;
 
-            for (const auto &child : part->children())
-                if (child == p)
-                    return d;
-        }
+    const PartitionTable* table = static_cast<const PartitionTable*>(root);
+    Device* d = m_DeviceIndex.value(table);
+
+    if (d == nullptr || d->partitionTable() != table) {
+        const auto devices = previewDevices();
+        auto it = std::find_if(devices.cbegin(), devices.cend(), [table] (const Device* device) { return device->partitionTable() == table; });
+        if (it == devices.cend())
+            return nullptr;
+
+        d = *it;
     }
 
-    return nullptr;
+    return isInTable(*table, p) ? d : nullptr;
+}
+
+/** Indexes the preview Devices by their PartitionTable again.
+
+    Operations like CreatePartitionTableOperation replace the PartitionTable of a Device
+    in their preview, so this is done whenever Operations are pushed or popped.
+*/
+void OperationStack::rebuildDeviceIndex()
+{
+    m_DeviceIndex.clear();
+
+    for (Device *d : std::as_const(previewDevices()))
+        if (d->partitionTable())
+            m_DeviceIndex.insert(d->partitionTable(), d);
 }
 
 /** Adds a Device to the OperationStack
@@ -540,6 +681,11 @@ void OperationStack::addDevice(Device* d)
     QWriteLocker lockDevices(&lock());
 
     previewDevices().append(d);
+
+    if (d->partitionTable())
+        m_DeviceIndex.insert(d->partitionTable(), d);
+    clearOperationIndex();
+
     Q_EMIT devicesChanged();
 }
 
@@ -14,14 +14,17 @@
 
 #include "util/libpartitionmanagerexport.h"
 
+#include <QHash>
 #include <QObject>
 #include <QList>
+#include <QMutex>
 #include <QReadWriteLock>
 
 #include <QtGlobal>
 
 class Device;
 class Partition;
+class PartitionTable;
 class Operation;
 class DeviceScanner;
 
@@ -55,6 +58,7 @@ public:
     void push(Operation* o);
     void pop();
     bool contains(const Partition* p) const;
+    Operations operationsFor(const Partition* p) const;
     void clearOperations();
     int size() const {
         return operations().size();    /**< @return number of operations */
@@ -87,15 +91,22 @@ protected:
 
     bool mergeNewOperation(Operation*& currentOp, Operation*& pushedOp);
     bool mergeCopyOperation(Operation*& currentOp, Operation*& pushedOp);
+    bool mergeResizeOperation(Operation*& currentOp, Operation*& pushedOp);
     bool mergeRestoreOperation(Operation*& currentOp, Operation*& pushedOp);
     bool mergePartFlagsOperation(Operation*& currentOp, Operation*& pushedOp);
     bool mergePartLabelOperation(Operation*& currentOp, Operation*& pushedOp);
     bool mergeCreatePartitionTableOperation(Operation*& currentOp, Operation*& pushedOp);
     bool mergeResizeVolumeGroupResizeOperation(Operation*& pushedOp);
 
+    void rebuildDeviceIndex();
+    void clearOperationIndex();
+
 private:
     Operations m_Operations;
     mutable Devices m_PreviewDevices;
+    QHash<const PartitionTable*, Device*> m_DeviceIndex; /**< preview Devices by their PartitionTable */
+    mutable QHash<const Partition*, Operations> m_OperationIndex; /**< Operations touching a Partition, filled on demand */
+    mutable QMutex m_OperationIndexMutex; /**< guards m_OperationIndex, readers of the stack fill it too */
     QReadWriteLock m_Lock;
 };
 
@@ -221,8 +221,7 @@ public:
     }
 
     void append(Partition* p) override {
-        m_Children.append(p);
-        std::sort(m_Children.begin(), m_Children.end(), [] (const Partition *a, const Partition *b) -> bool {return a->firstSector() < b->firstSector();});
+        m_Children.insert(insertPosition(p->firstSector()), p);
     }
     void setDevicePath(const QString& s) {
         m_DevicePath = s;
@@ -13,6 +13,33 @@
 
 #include "fs/filesystem.h"
 
+#include <algorithm>
+
+/* Children are kept sorted by their first sector and do not overlap, apart from
+ * unallocated children for a moment while a preview partition is inserted.
+ */
+static qsizetype indexOf(const PartitionNode::Partitions& plist, const Partition* p)
+{
+    auto it = std::lower_bound(plist.cbegin(), plist.cend(), p->firstSector(), [] (const Partition* child, qint64 sector) { return child->firstSector() < sector; });
+    for (; it != plist.cend() && (*it)->firstSector() == p->firstSector(); ++it)
+        if (*it == p)
+            return it - plist.cbegin();
+
+    // The sectors of p were changed after it was inserted
+    return plist.indexOf(const_cast<Partition*>(p));
+}
+
+/** @return the child that contains sector s or nullptr if there is none */
+static Partition* childAt(const PartitionNode::Partitions& plist, qint64 s)
+{
+    auto it = std::upper_bound(plist.cbegin(), plist.cend(), s, [] (qint64 sector, const Partition* child) { return sector < child->firstSector(); });
+    if (it == plist.cbegin())
+        return nullptr;
+
+    Partition* p = *(it - 1);
+    return s <= p->lastSector() ? p : nullptr;
+}
+
 /** Tries to find the predecessor for a Partition.
     @param p the Partition to find a predecessor for
     @return pointer to the predecessor or nullptr if none was found
@@ -23,11 +50,8 @@ Partition* PartitionNode::predecessor(Partition& p)
 
     Partitions& plist = p.parent()->isRoot() == false ? p.parent()->children() : children();
 
-    for (int idx = 1; idx < plist.size(); idx++)
-        if (plist[idx] == &p)
-            return plist[idx - 1];
-
-    return nullptr;
+    const qsizetype idx = indexOf(plist, &p);
+    return idx > 0 ? plist[idx - 1] : nullptr;
 }
 
 /**
@@ -39,11 +63,8 @@ const Partition* PartitionNode::predecessor(const Partition& p) const
 
     const Partitions& plist = p.parent()->isRoot() == false ? p.parent()->children() : children();
 
-    for (int idx = 1; idx < plist.size(); idx++)
-        if (plist[idx] == &p)
-            return plist[idx - 1];
-
-    return nullptr;
+    const qsizetype idx = indexOf(plist, &p);
+    return idx > 0 ? plist[idx - 1] : nullptr;
 }
 
 /** Tries to find the successor for a Partition.
@@ -56,11 +77,8 @@ Partition* PartitionNode::successor(Partition& p)
 
     Partitions& plist = p.parent()->isRoot() == false ? p.parent()->children() : children();
 
-    for (int idx = plist.size() - 2; idx >= 0; idx--)
-        if (plist[idx] == &p)
-            return plist[idx + 1];
-
-    return nullptr;
+    const qsizetype idx = indexOf(plist, &p);
+    return idx >= 0 && idx < plist.size() - 1 ? plist[idx + 1] : nullptr;
 }
 
 /**
@@ -72,11 +90,8 @@ const Partition* PartitionNode::successor(const Partition& p) const
 
     const Partitions& plist = p.parent()->isRoot() == false ? p.parent()->children() : children();
 
-    for (int idx = plist.size() - 2; idx >= 0; idx--)
-        if (plist[idx] == &p)
-            return plist[idx + 1];
-
-    return nullptr;
+    const qsizetype idx = indexOf(plist, &p);
+    return idx >= 0 && idx < plist.size() - 1 ? plist[idx + 1] : nullptr;
 }
 
 /** Inserts a Partition into a PartitionNode's children
@@ -88,14 +103,7 @@ bool PartitionNode::insert(Partition* p)
     if (p == nullptr)
         return false;
 
-    for (int idx = 0; idx < children().size(); idx++) {
-        if (children()[idx]->firstSector() > p->firstSector()) {
-            children().insert(idx, p);
-            return true;
-        }
-    }
-
-    children().insert(children().size(), p);
+    children().insert(insertPosition(p->firstSector()), p);
 
     return true;
 }
@@ -109,7 +117,19 @@ bool PartitionNode::remove(Partition* p)
     if (p == nullptr)
         return false;
 
-    return children().removeOne(p);
+    const qsizetype idx = indexOf(children(), p);
+    if (idx < 0)
+        return false;
+
+    children().removeAt(idx);
+    return true;
+}
+
+/** @return the index a child starting at sector @p firstSector has to be inserted at to keep the children sorted */
+qsizetype PartitionNode::insertPosition(qint64 firstSector) const
+{
+    const Partitions& plist = children();
+    return std::upper_bound(plist.cbegin(), plist.cend(), firstSector, [] (qint64 sector, const Partition* p) { return sector < p->firstSector(); }) - plist.cbegin();
 }
 
 /** Deletes all children */
@@ -126,19 +146,16 @@ void PartitionNode::clearChildren()
 */
 Partition* PartitionNode::findPartitionBySector(qint64 s, const PartitionRole& role)
 {
-    const auto partitions = children();
-    for (auto &p : partitions) {
-        // (women and) children first. ;-)
-        const auto pChildren = p->children();
-        for (auto &child : pChildren)
-            if ((child->roles().roles() & role.roles()) && s >= child->firstSector() && s <= child->lastSector())
-                return child;
-
-        if ((p->roles().roles() & role.roles()) && s >= p->firstSector() && s <= p->lastSector())
-            return p;
-    }
-
-    return nullptr;
+    Partition* p = childAt(children(), s);
+    if (p == nullptr)
+        return nullptr;
+
+    // (women and) children first. ;-)
+    Partition* child = childAt(p->children(), s);
+    if (child && (child->roles().roles() & role.roles()))
+        return child;
+
+    return (p->roles().roles() & role.roles()) ? p : nullptr;
 }
 
 /**
@@ -146,16 +163,15 @@ Partition* PartitionNode::findPartitionBySector(qint64 s, const PartitionRole& r
 */
 const Partition* PartitionNode::findPartitionBySector(qint64 s, const PartitionRole& role) const
 {
-    for (const auto *p : children()) {
-        for (const auto &child : p->children())
-            if ((child->roles().roles() & role.roles()) && s >= child->firstSector() && s <= child->lastSector())
-                return child;
+    const Partition* p = childAt(children(), s);
+    if (p == nullptr)
+        return nullptr;
 
-        if ((p->roles().roles() & role.roles()) && s >= p->firstSector() && s <= p->lastSector())
-            return p;
-    }
+    const Partition* child = childAt(p->children(), s);
+    if (child && (child->roles().roles() & role.roles()))
+        return child;
 
-    return nullptr;
+    return (p->roles().roles() & role.roles()) ? p : nullptr;
 }
 
 /** Reparents a Partition to this PartitionNode
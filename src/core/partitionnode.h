@@ -23,6 +23,9 @@ class PartitionRole;
     The root in this tree is the PartitionTable. The primaries are the child nodes; extended partitions again
     have child nodes.
 
+    Children are kept sorted by their first sector, so finding a Partition by sector and inserting or
+    removing one are binary searches.
+
     @see Device, PartitionTable, Partition
     @author Volker Lanz <vl@fidra.de>
 */
@@ -60,6 +63,7 @@ public:
 
 protected:
     virtual void clearChildren();
+    qsizetype insertPosition(qint64 firstSector) const;
 };
 
 #endif
@@ -166,8 +166,7 @@ int PartitionTable::numPrimaries() const
 */
 void PartitionTable::append(Partition* partition)
 {
-    children().append(partition);
-    std::sort(children().begin(), children().end(), [] (const Partition *a, const Partition *b) -> bool {return a->firstSector() < b->firstSector();});
+    children().insert(insertPosition(partition->firstSector()), partition);
 }
 
 /** @param f the flag to get the name for
@@ -365,13 +364,51 @@ void PartitionTable::removeUnallocated()
     removeUnallocated(this);
 }
 
-/** Inserts unallocated children for a Device's PartitionTable with the given parent.
+/** Takes an unallocated Partition for a gap out of the ones a PartitionNode had before, or creates one.
 
-    This method inserts unallocated Partitions for a parent, usually the Device this
-    PartitionTable is on. It will also insert unallocated Partitions in any extended
-    Partitions it finds.
+    One that overlaps the gap is preferred, so unallocated Partitions in unchanged parts of
+    the table keep their identity.
 
-    @warning This method assumes that no unallocated Partitions exist when it is called.
+    @param device the Device the gap is on
+    @param parent the parent PartitionNode of the gap
+    @param start the first sector of the gap
+    @param end the last sector of the gap
+    @param spare the previous unallocated children of @p parent that were not reused yet
+    @return pointer to the unallocated Partition or nullptr if the gap is too small
+*/
+static Partition* reuseUnallocated(const Device& device, PartitionNode& parent, qint64 start, qint64 end, QList<Partition*>& spare)
+{
+    if (spare.isEmpty())
+        return createUnallocated(device, parent, start, end);
+
+    if (!PartitionTable::getUnallocatedRange(device, parent, start, end))
+        return nullptr;
+
+    qsizetype idx = 0;
+    for (qsizetype i = 0; i < spare.size(); i++) {
+        if (spare[i]->firstSector() <= end && spare[i]->lastSector() >= start) {
+            idx = i;
+            break;
+        }
+    }
+
+    Partition* p = spare.takeAt(idx);
+    p->setFirstSector(start);
+    p->setLastSector(end);
+    p->fileSystem().setFirstSector(start);
+    p->fileSystem().setLastSector(end);
+
+    return p;
+}
+
+/** Updates the unallocated children for a Device's PartitionTable with the given parent.
+
+    This method makes the unallocated Partitions of a parent, usually the Device this
+    PartitionTable is on, match the free space between its other children. It will also
+    update the unallocated Partitions in any extended Partitions it finds.
+
+    Unallocated Partitions that are still needed are moved to the new gaps instead of
+    being deleted and created again, only the ones left over are deleted.
 
     @param d the Device this PartitionTable and @p p are on
     @param p the parent PartitionNode (may be this or an extended Partition)
@@ -381,23 +418,37 @@ void PartitionTable::insertUnallocated(const Device& d, PartitionNode* p, qint64
 {
     Q_ASSERT(p);
 
+    QList<Partition*> spare;
+    Partitions result;
+    result.reserve(p->children().size() + 1);
+
+    for (const auto &child : std::as_const(p->children())) {
+        if (child->roles().has(PartitionRole::Unallocated))
+            spare.append(child);
+        else
+            result.append(child);
+    }
+
     qint64 lastEnd = start;
 
-    if (d.type() == Device::Type::LVM_Device && !p->children().isEmpty()) {
+    if (d.type() == Device::Type::LVM_Device && !result.isEmpty()) {
         // rearranging the sectors of all partitions to keep unallocated space at the end
         lastEnd = 0;
-        std::sort(children().begin(), children().end(), [](const Partition* p1, const Partition* p2) { return p1->deviceNode() < p2->deviceNode(); });
-        for (const auto &child : children()) {
+        std::sort(result.begin(), result.end(), [](const Partition* p1, const Partition* p2) { return p1->deviceNode() < p2->deviceNode(); });
+        for (const auto &child : std::as_const(result)) {
             qint64 totalSectors = child->length();
             child->setFirstSector(lastEnd);
             child->setLastSector(lastEnd + totalSectors - 1);
 
             lastEnd += totalSectors;
         }
-    } else {
-        const auto pChildren = p->children();
-        for (const auto &child : pChildren) {
-            p->insert(createUnallocated(d, *p, lastEnd, child->firstSector() - 1));
+    } else if (d.type() != Device::Type::LVM_Device) {
+        const Partitions children = result;
+        result.clear();
+        for (const auto &child : children) {
+            if (Partition* gap = reuseUnallocated(d, *p, lastEnd, child->firstSector() - 1, spare))
+                result.append(gap);
+            result.append(child);
 
             if (child->roles().has(PartitionRole::Extended))
                 insertUnallocated(d, child, child->firstSector());
@@ -406,10 +457,11 @@ void PartitionTable::insertUnallocated(const Device& d, PartitionNode* p, qint64
         }
     }
 
+    Partition* last = nullptr;
     if (d.type() == Device::Type::LVM_Device)
     {
         const LvmDevice& lvm = static_cast<const LvmDevice&>(d);
-        p->insert(createUnallocated(d, *p, lastEnd, lastEnd + lvm.freePE() - 1));
+        last = reuseUnallocated(d, *p, lastEnd, lastEnd + lvm.freePE() - 1, spare);
     }
     else
     {
@@ -424,8 +476,14 @@ void PartitionTable::insertUnallocated(const Device& d, PartitionNode* p, qint64
         }
 
         if (parentEnd >= firstUsable() && parentEnd >= lastEnd)
-            p->insert(createUnallocated(d, *p, lastEnd, parentEnd));
+            last = reuseUnallocated(d, *p, lastEnd, parentEnd, spare);
     }
+
+    if (last)
+        result.append(last);
+
+    p->children() = result;
+    qDeleteAll(spare);
 }
 
 /** Updates the unallocated Partitions for this PartitionTable.
@@ -433,7 +491,6 @@ void PartitionTable::insertUnallocated(const Device& d, PartitionNode* p, qint64
 */
 void PartitionTable::updateUnallocated(const Device& d)
 {
-    removeUnallocated();
     insertUnallocated(d, this, firstUsable());
 }
 
@@ -0,0 +1,270 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "core/raid/raidmonitor.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+/** Interval for sampling md/sync_speed while an array is syncing */
+constexpr int speedInterval = 2000;
+
+RaidMonitor::RaidMonitor(QObject* parent) :
+    QThread(parent)
+{
+    if (pipe2(m_WakeFd, O_CLOEXEC | O_NONBLOCK) != 0)
+        m_WakeFd[0] = m_WakeFd[1] = -1;
+}
+
+RaidMonitor::~RaidMonitor()
+{
+    stop();
+
+    for (Watch& w : m_Watches)
+        closeWatch(w);
+    for (Watch& w : m_Retired)
+        closeWatch(w);
+
+    if (m_WakeFd[0] >= 0) {
+        close(m_WakeFd[0]);
+        close(m_WakeFd[1]);
+    }
+}
+
+/** Start watching an array.
+    @param deviceNode the device node of the array, e.g. /dev/md0
+    @return true if the array exports its state in sysfs
+*/
+bool RaidMonitor::watch(const QString& deviceNode)
+{
+    const QString kernelName = QFileInfo(deviceNode).canonicalFilePath().section(QLatin1Char('/'), -1);
+    if (kernelName.isEmpty())
+        return false;
+
+    Watch w;
+    w.deviceNode = deviceNode;
+    w.mdDir = QStringLiteral("/sys/class/block/") + kernelName + QStringLiteral("/md/");
+
+    auto openAttribute = [&w] (const QString& name) {
+        return open(QFile::encodeName(w.mdDir + name).constData(), O_RDONLY | O_CLOEXEC);
+    };
+    w.completedFd = openAttribute(QStringLiteral("sync_completed"));
+    w.actionFd = openAttribute(QStringLiteral("sync_action"));
+    w.degradedFd = openAttribute(QStringLiteral("degraded"));
+
+    // RAID 0 and linear arrays have nothing to sync
+    if (w.completedFd < 0 || w.actionFd < 0) {
+        closeWatch(w);
+        return false;
+    }
+
+    // Read the state right away so isSyncing() is valid and the first notification is armed
+    Notifications notifications;
+    update(w, notifications);
+
+    {
+        QMutexLocker locker(&m_Mutex);
+        for (const Watch& other : std::as_const(m_Watches)) {
+            if (other.deviceNode == deviceNode) {
+                closeWatch(w);
+                return true;
+            }
+        }
+        m_Watches.append(w);
+        wakeUp();
+    }
+
+    for (const auto &notify : std::as_const(notifications))
+        notify();
+
+    return true;
+}
+
+/** Stop watching an array.
+    @param deviceNode the device node the array was watched with
+*/
+void RaidMonitor::unwatch(const QString& deviceNode)
+{
+    QMutexLocker locker(&m_Mutex);
+    for (qsizetype i = 0; i < m_Watches.size(); ++i) {
+        if (m_Watches[i].deviceNode != deviceNode)
+            continue;
+
+        // The thread closes the file descriptors once it is not polling them anymore
+        Watch w = m_Watches.takeAt(i);
+        if (isRunning()) {
+            m_Retired.append(w);
+            wakeUp();
+        }
+        else
+            closeWatch(w);
+        return;
+    }
+}
+
+/** Stop the thread and wait for it to finish. */
+void RaidMonitor::stop()
+{
+    requestInterruption();
+    wakeUp();
+    wait();
+}
+
+/** @return true if a resync, recovery, check or reshape is running on the array */
+bool RaidMonitor::isSyncing(const QString& deviceNode) const
+{
+    QMutexLocker locker(&m_Mutex);
+    for (const Watch& w : m_Watches)
+        if (w.deviceNode == deviceNode)
+            return !w.action.isEmpty() && w.action != QStringLiteral("idle") && w.action != QStringLiteral("frozen");
+
+    return false;
+}
+
+void RaidMonitor::run()
+{
+    while (!isInterruptionRequested()) {
+        QList<pollfd> fds;
+        bool syncing = false;
+        {
+            QMutexLocker locker(&m_Mutex);
+            for (Watch& w : m_Retired)
+                closeWatch(w);
+            m_Retired.clear();
+
+            fds.append({ m_WakeFd[0], POLLIN, 0 });
+            for (const Watch& w : std::as_const(m_Watches)) {
+                // sysfs signals changes with POLLPRI | POLLERR after the attribute was read
+                fds.append({ w.completedFd, POLLPRI | POLLERR, 0 });
+                fds.append({ w.actionFd, POLLPRI | POLLERR, 0 });
+                if (w.degradedFd >= 0)
+                    fds.append({ w.degradedFd, POLLPRI | POLLERR, 0 });
+                syncing = syncing || (!w.action.isEmpty() && w.action != QStringLiteral("idle") && w.action != QStringLiteral("frozen"));
+            }
+        }
+
+        const int ready = poll(fds.data(), fds.size(), syncing ? speedInterval : -1);
+        if (ready < 0 && errno != EINTR)
+            break;
+
+        if (fds[0].revents & POLLIN) {
+            char buffer[64];
+            while (read(m_WakeFd[0], buffer, sizeof(buffer)) > 0)
+                ;
+        }
+
+        Notifications notifications;
+        {
+            QMutexLocker locker(&m_Mutex);
+            for (Watch& w : m_Watches) {
+                for (const pollfd& fd : std::as_const(fds)) {
+                    if ((fd.fd == w.completedFd || fd.fd == w.actionFd || fd.fd == w.degradedFd) && fd.revents) {
+                        update(w, notifications);
+                        break;
+                    }
+                }
+
+                // sync_speed has no notifications, sample it while syncing
+                if (ready == 0)
+                    update(w, notifications);
+            }
+        }
+
+        // Emit without holding the mutex, receivers may call back into the monitor
+        for (const auto &notify : std::as_const(notifications))
+            notify();
+    }
+}
+
+/* Reads the state of an array and queues the signals to emit in @p notifications. Every
+ * watched attribute has to be read after a notification to arm the next one.
+ *
+ * sync_completed is "done / total" in sectors or "none", sync_speed is in KiB/s.
+ */
+void RaidMonitor::update(Watch& w, Notifications& notifications)
+{
+    const QString action = QString::fromLatin1(readAttribute(w.actionFd));
+    const QByteArray completed = readAttribute(w.completedFd);
+
+    if (w.degradedFd >= 0) {
+        bool ok;
+        const int degraded = readAttribute(w.degradedFd).toInt(&ok);
+        if (ok && degraded != w.degraded) {
+            const bool initial = w.degraded < 0;
+            w.degraded = degraded;
+            if (!initial || degraded > 0)
+                notifications.append([this, deviceNode = w.deviceNode, degraded] { Q_EMIT degradedChanged(deviceNode, degraded); });
+        }
+    }
+
+    const bool wasSyncing = !w.action.isEmpty() && w.action != QStringLiteral("idle") && w.action != QStringLiteral("frozen");
+    const bool syncing = action != QStringLiteral("idle") && action != QStringLiteral("frozen") && !action.isEmpty();
+    w.action = action;
+
+    if (!syncing) {
+        if (wasSyncing)
+            notifications.append([this, deviceNode = w.deviceNode] { Q_EMIT syncFinished(deviceNode); });
+        return;
+    }
+
+    const QList<QByteArray> parts = completed.split('/');
+    if (parts.size() != 2)
+        return;
+
+    const qint64 done = parts[0].trimmed().toLongLong();
+    const qint64 total = parts[1].trimmed().toLongLong();
+    if (total <= 0)
+        return;
+
+    QFile speedFile(w.mdDir + QStringLiteral("sync_speed"));
+    qint64 speed = 0;
+    if (speedFile.open(QIODevice::ReadOnly))
+        speed = speedFile.readAll().trimmed().toLongLong() * 1024;
+
+    const qint64 secondsLeft = speed > 0 ? (total - done) * 512 / speed : -1;
+    const double percent = 100.0 * done / total;
+    notifications.append([this, deviceNode = w.deviceNode, action, percent, speed, secondsLeft] {
+        Q_EMIT syncProgress(deviceNode, action, percent, speed, secondsLeft);
+    });
+}
+
+void RaidMonitor::wakeUp()
+{
+    if (m_WakeFd[1] >= 0) {
+        const char c = 0;
+        [[maybe_unused]] ssize_t n = write(m_WakeFd[1], &c, 1);
+    }
+}
+
+void RaidMonitor::closeWatch(Watch& w)
+{
+    for (int* fd : { &w.completedFd, &w.actionFd, &w.degradedFd }) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+/** @return the trimmed content of a sysfs attribute, read from its start */
+QByteArray RaidMonitor::readAttribute(int fd)
+{
+    if (fd < 0)
+        return QByteArray();
+
+    char buffer[256];
+    const ssize_t n = pread(fd, buffer, sizeof(buffer) - 1, 0);
+    return n > 0 ? QByteArray(buffer, n).trimmed() : QByteArray();
+}
+
+#include "moc_raidmonitor.cpp"
@@ -0,0 +1,98 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_RAIDMONITOR_H
+#define KPMCORE_RAIDMONITOR_H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+
+#include <functional>
+
+/** Thread watching Software RAID arrays for resync and recovery progress.
+
+    The kernel notifies pollers of md/sync_completed, md/sync_action and
+    md/degraded in sysfs when they change, so the thread sleeps in poll() until
+    something happens. While an array is syncing, md/sync_speed is sampled every
+    few seconds as it has no notifications.
+
+    This allows clients to show the progress of a resync and to run heavy jobs
+    on the array after it finished instead of competing for bandwidth, which is
+    what OperationRunner does.
+
+    @author kpmcore contributors
+*/
+class LIBKPMCORE_EXPORT RaidMonitor : public QThread
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(RaidMonitor)
+
+public:
+    explicit RaidMonitor(QObject* parent = nullptr);
+    ~RaidMonitor() override;
+
+public:
+    bool watch(const QString& deviceNode);
+    void unwatch(const QString& deviceNode);
+    void stop();
+
+    bool isSyncing(const QString& deviceNode) const;
+
+Q_SIGNALS:
+    /** Emitted when a resync, recovery, check or reshape makes progress.
+        @param deviceNode the array
+        @param action the value of md/sync_action, e.g. "resync" or "recover"
+        @param percent progress of the action from 0 to 100
+        @param speed current speed in bytes per second
+        @param secondsLeft estimated time to completion or -1 if unknown
+    */
+    void syncProgress(const QString& deviceNode, const QString& action, double percent, qint64 speed, qint64 secondsLeft);
+
+    /** Emitted when an array becomes idle again after a resync, recovery, check or reshape.
+        @param deviceNode the array
+    */
+    void syncFinished(const QString& deviceNode);
+
+    /** Emitted when the number of missing members of an array changes.
+        @param deviceNode the array
+        @param degraded the number of missing members
+    */
+    void degradedChanged(const QString& deviceNode, int degraded);
+
+protected:
+    void run() override;
+
+private:
+    struct Watch {
+        QString deviceNode;
+        QString mdDir;
+        int completedFd = -1;
+        int actionFd = -1;
+        int degradedFd = -1;
+        QString action;
+        int degraded = -1;
+    };
+
+    /** Signals to emit once m_Mutex is unlocked */
+    typedef QList<std::function<void()>> Notifications;
+
+    void update(Watch& w, Notifications& notifications);
+    void wakeUp();
+    static void closeWatch(Watch& w);
+    static QByteArray readAttribute(int fd);
+
+private:
+    mutable QMutex m_Mutex;
+    QList<Watch> m_Watches;
+    QList<Watch> m_Retired;     /**< unwatched while the thread may be polling them */
+    int m_WakeFd[2];
+};
+
+#endif
@@ -14,10 +14,14 @@
 #include "fs/filesystemfactory.h"
 #include "util/externalcommand.h"
 
+#include <limits>
 #include <utility>
 
 #include <KLocalizedString>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QMap>
 #include <QRegularExpression>
 
 #define d_ptr std::static_pointer_cast<SoftwareRAIDPrivate>(d)
@@ -35,23 +39,54 @@ public:
     SoftwareRAID::Status m_status;
 };
 
+/** Everything known about an array, read at once from sysfs or a single mdadm --detail */
+struct SoftwareRAID::Details
+{
+    qint32 raidLevel = -1;
+    qint64 chunkSize = -1;      /**< in KiB like mdadm prints it, RAID 1 uses the sector size instead */
+    qint64 arraySize = -1;      /**< in bytes */
+    QString uuid;
+    QStringList devicePathList;
+    QString arrayState;         /**< md/array_state, empty if sysfs was not available */
+    QString syncAction;         /**< md/sync_action, empty if sysfs was not available */
+
+    qint64 totalChunk() const {
+        return chunkSize > 0 ? arraySize / chunkSize : -1;
+    }
+};
+
 SoftwareRAID::SoftwareRAID(const QString& name, SoftwareRAID::Status status, const QString& iconName)
+    : SoftwareRAID(name, status, iconName, readDetails(QStringLiteral("/dev/") + name))
+{
+}
+
+SoftwareRAID::SoftwareRAID(const QString& name, SoftwareRAID::Status status, const QString& iconName, const Details& details)
     : VolumeManagerDevice(std::make_shared<SoftwareRAIDPrivate>(),
                           name,
                           (QStringLiteral("/dev/") + name),
-                          getChunkSize(QStringLiteral("/dev/") + name),
-                          getTotalChunk(QStringLiteral("/dev/") + name),
+                          details.chunkSize,
+                          details.totalChunk(),
                           iconName,
                           Device::Type::SoftwareRAID_Device)
 {
-    d_ptr->m_raidLevel = getRaidLevel(deviceNode());
+    d_ptr->m_raidLevel = details.raidLevel;
     d_ptr->m_chunkSize = logicalSize();
     d_ptr->m_totalChunk = totalLogical();
-    d_ptr->m_arraySize = getArraySize(deviceNode());
-    d_ptr->m_UUID = getUUID(deviceNode());
-    d_ptr->m_devicePathList = getDevicePathList(deviceNode());
+    d_ptr->m_arraySize = details.arraySize;
+    d_ptr->m_UUID = details.uuid;
+    d_ptr->m_devicePathList = details.devicePathList;
     d_ptr->m_status = status;
 
+    // sysfs knows the state of an array that is reported as active
+    if (status == SoftwareRAID::Status::Active) {
+        if (details.arrayState == QStringLiteral("inactive"))
+            d_ptr->m_status = SoftwareRAID::Status::Inactive;
+        else if (details.raidLevel > 0 && details.syncAction == QStringLiteral("resync"))
+            d_ptr->m_status = SoftwareRAID::Status::Resync;
+        else if (details.raidLevel > 0 && details.syncAction == QStringLiteral("recover"))
+            d_ptr->m_status = SoftwareRAID::Status::Recovery;
+    }
+
     initPartitions();
 }
 
@@ -231,76 +266,47 @@ void SoftwareRAID::scanSoftwareRAID(QList<Device*>& devices)
 
 qint32 SoftwareRAID::getRaidLevel(const QString &path)
 {
-    QString output = getDetail(path);
-
-    if (!output.isEmpty()) {
-        QRegularExpression re(QStringLiteral("Raid Level :\\s+\\w+(\\d+)"));
-        QRegularExpressionMatch reMatch = re.match(output);
-        if (reMatch.hasMatch())
-            return reMatch.captured(1).toLongLong();
-    }
-
-    return -1;
+    return readDetails(path).raidLevel;
 }
 
 qint64 SoftwareRAID::getChunkSize(const QString &path)
 {
-    if (getRaidLevel(path) == 1) {
-        QStringList devices = getDevicePathList(path);
-
-        if (!devices.isEmpty()) {
-            QString device = devices[0];
-            // Look sector size for the first device/partition on the list, as RAID 1 is composed by mirrored devices
-            ExternalCommand sectorSize(QStringLiteral("blockdev"), { QStringLiteral("--getss"), device });
-
-            if (sectorSize.run(-1) && sectorSize.exitCode() == 0) {
-                int sectors = sectorSize.output().trimmed().toLongLong();
-                return sectors;
-            }
-        }
-    }
-    else {
-        QString output = getDetail(path);
-        if (!output.isEmpty()) {
-            QRegularExpression re(QStringLiteral("Chunk Size :\\s+(\\d+)"));
-            QRegularExpressionMatch reMatch = re.match(output);
-            if (reMatch.hasMatch())
-                return reMatch.captured(1).toLongLong();
-        }
-    }
-    return -1;
-
+    return readDetails(path).chunkSize;
 }
 
 qint64 SoftwareRAID::getTotalChunk(const QString &path)
 {
-    return getArraySize(path) / getChunkSize(path);
+    return readDetails(path).totalChunk();
 }
 
 qint64 SoftwareRAID::getArraySize(const QString &path)
 {
-    QString output = getDetail(path);
-    if (!output.isEmpty()) {
-        QRegularExpression re(QStringLiteral("Array Size :\\s+(\\d+)"));
-        QRegularExpressionMatch reMatch = re.match(output);
-        if (reMatch.hasMatch())
-            return reMatch.captured(1).toLongLong() * 1024;
-    }
-    return -1;
-
+    return readDetails(path).arraySize;
 }
 
 QString SoftwareRAID::getUUID(const QString &path)
 {
-    QString output = getDetail(path);
+    return readDetails(path).uuid;
+}
 
-    if (!output.isEmpty()) {
-        QRegularExpression re(QStringLiteral("UUID :\\s+([\\w:]+)"));
-        QRegularExpressionMatch reMatch = re.match(output);
+QStringList SoftwareRAID::getDevicePathList(const QString &path)
+{
+    return readDetails(path).devicePathList;
+}
 
-        if (reMatch.hasMatch())
-            return reMatch.captured(1);
-    }
+/** Read all details of the array at path.
+
+    The kernel exports everything needed in /sys/block/mdX/md, mdadm --detail is only
+    run for arrays that are not known to the kernel.
+*/
+SoftwareRAID::Details SoftwareRAID::readDetails(const QString &path)
+{
+    Details details;
+    if (!readSysfsDetails(path, details))
+        readMdadmDetails(path, details);
+
+    if (!details.uuid.isEmpty())
+        return details;
 
     // If UUID was not found in detail output, it should be searched in config file
 
@@ -330,35 +336,154 @@ QString SoftwareRAID::getUUID(const QString &path)
                 QRegularExpression reUUID(QStringLiteral("(UUID=|uuid=)([\\w:]+)"));
                 QRegularExpressionMatch uuidMatch = reUUID.match(otherInfo);
 
-                if (uuidMatch.hasMatch())
-                    return uuidMatch.captured(2);
+                if (uuidMatch.hasMatch()) {
+                    details.uuid = uuidMatch.captured(2);
+                    break;
+                }
             }
         }
     }
 
-    return QString();
+    return details;
 }
 
-QStringList SoftwareRAID::getDevicePathList(const QString &path)
+static QString readSysfsAttribute(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return QString();
+    return QString::fromLatin1(file.readAll().trimmed());
+}
+
+/* /sys/block/mdX/md contains
+ *   level          e.g. raid1, empty for inactive arrays
+ *   chunk_size     in bytes
+ *   array_state    e.g. clean, active, inactive
+ *   sync_action    idle, resync, recover, check, ...
+ *   dev-NAME/slot  position of member NAME in the array or "none" for spares
+ * and /sys/block/mdX/size is the size of the array in 512 byte sectors.
+ */
+bool SoftwareRAID::readSysfsDetails(const QString &path, Details &details)
 {
-    QStringList result;
+    const QString kernelName = QFileInfo(path).canonicalFilePath().section(QLatin1Char('/'), -1);
+    if (kernelName.isEmpty())
+        return false;
 
-    QString detail = getDetail(path);
+    const QString blockDir = QStringLiteral("/sys/class/block/") + kernelName;
+    const QString mdDir = blockDir + QStringLiteral("/md");
+    if (!QFileInfo::exists(mdDir))
+        return false;
 
-    if (!detail.isEmpty()) {
-        QRegularExpression re(QStringLiteral("\\s+\\/dev\\/(\\w+)"));
-        QRegularExpressionMatchIterator i = re.globalMatch(detail);
+    details.arrayState = readSysfsAttribute(mdDir + QStringLiteral("/array_state"));
+    details.syncAction = readSysfsAttribute(mdDir + QStringLiteral("/sync_action"));
 
-        while (i.hasNext()) {
-            QRegularExpressionMatch match = i.next();
+    const QString level = readSysfsAttribute(mdDir + QStringLiteral("/level"));
+    if (level.startsWith(QStringLiteral("raid"))) {
+        bool ok;
+        const qint32 raidLevel = level.mid(4).toInt(&ok);
+        if (ok)
+            details.raidLevel = raidLevel;
+    }
 
-            QString device = QStringLiteral("/dev/") + match.captured(1);
-            if (device != path)
-                result << device;
+    const qint64 sectors = readSysfsAttribute(blockDir + QStringLiteral("/size")).toLongLong();
+    if (sectors > 0)
+        details.arraySize = sectors * 512;
+
+    // Members ordered by their slot, spares last
+    QMap<qint64, QString> members;
+    const QFileInfoList memberDirs = QDir(mdDir).entryInfoList({ QStringLiteral("dev-*") }, QDir::Dirs);
+    for (const QFileInfo& memberDir : memberDirs) {
+        bool ok;
+        qint64 slot = readSysfsAttribute(memberDir.filePath() + QStringLiteral("/slot")).toLongLong(&ok);
+        if (!ok)
+            slot = std::numeric_limits<qint32>::max() + members.size();
+        members.insert(slot, QStringLiteral("/dev/") + memberDir.fileName().mid(4));
+    }
+    details.devicePathList = members.values();
+
+    // RAID 1 is composed by mirrored devices and uses the sector size of the first one
+    if (details.raidLevel == 1) {
+        if (!details.devicePathList.isEmpty())
+            details.chunkSize = logicalBlockSize(details.devicePathList.first());
+    }
+    else {
+        const qint64 chunkSize = readSysfsAttribute(mdDir + QStringLiteral("/chunk_size")).toLongLong();
+        if (chunkSize > 0)
+            details.chunkSize = chunkSize / 1024;
+    }
+
+    // udev links the array as md-uuid-UUID with the UUID in the same format as mdadm uses
+    const QFileInfoList links = QDir(QStringLiteral("/dev/disk/by-id")).entryInfoList({ QStringLiteral("md-uuid-*") }, QDir::Files | QDir::System);
+    for (const QFileInfo& link : links) {
+        if (link.canonicalFilePath().section(QLatin1Char('/'), -1) == kernelName) {
+            details.uuid = link.fileName().mid(8);
+            break;
         }
     }
 
-    return result;
+    return true;
+}
+
+void SoftwareRAID::readMdadmDetails(const QString &path, Details &details)
+{
+    const QString output = getDetail(path);
+    if (output.isEmpty())
+        return;
+
+    QRegularExpression reLevel(QStringLiteral("Raid Level :\\s+\\w+(\\d+)"));
+    QRegularExpressionMatch reMatch = reLevel.match(output);
+    if (reMatch.hasMatch())
+        details.raidLevel = reMatch.captured(1).toLongLong();
+
+    QRegularExpression reArraySize(QStringLiteral("Array Size :\\s+(\\d+)"));
+    reMatch = reArraySize.match(output);
+    if (reMatch.hasMatch())
+        details.arraySize = reMatch.captured(1).toLongLong() * 1024;
+
+    QRegularExpression reUUID(QStringLiteral("UUID :\\s+([\\w:]+)"));
+    reMatch = reUUID.match(output);
+    if (reMatch.hasMatch())
+        details.uuid = reMatch.captured(1);
+
+    QRegularExpression reDevice(QStringLiteral("\\s+\\/dev\\/(\\w+)"));
+    QRegularExpressionMatchIterator i = reDevice.globalMatch(output);
+    while (i.hasNext()) {
+        QString device = QStringLiteral("/dev/") + i.next().captured(1);
+        if (device != path)
+            details.devicePathList << device;
+    }
+
+    if (details.raidLevel == 1) {
+        // Look sector size for the first device/partition on the list, as RAID 1 is composed by mirrored devices
+        if (!details.devicePathList.isEmpty())
+            details.chunkSize = logicalBlockSize(details.devicePathList.first());
+    }
+    else {
+        QRegularExpression reChunkSize(QStringLiteral("Chunk Size :\\s+(\\d+)"));
+        reMatch = reChunkSize.match(output);
+        if (reMatch.hasMatch())
+            details.chunkSize = reMatch.captured(1).toLongLong();
+    }
+}
+
+/** @return the logical sector size of a disk or partition or -1 on error */
+qint64 SoftwareRAID::logicalBlockSize(const QString &devicePath)
+{
+    // Partitions have no queue directory, it is in the directory of their disk
+    QDir sysfsDir(QFileInfo(QStringLiteral("/sys/class/block/") + QFileInfo(devicePath).fileName()).canonicalFilePath());
+    if (!sysfsDir.path().isEmpty() && sysfsDir.path() != QStringLiteral(".")) {
+        if (!sysfsDir.exists(QStringLiteral("queue")))
+            sysfsDir.cdUp();
+        const qint64 size = readSysfsAttribute(sysfsDir.filePath(QStringLiteral("queue/logical_block_size"))).toLongLong();
+        if (size > 0)
+            return size;
+    }
+
+    ExternalCommand sectorSize(QStringLiteral("blockdev"), { QStringLiteral("--getss"), devicePath });
+    if (sectorSize.run(-1) && sectorSize.exitCode() == 0)
+        return sectorSize.output().trimmed().toLongLong();
+
+    return -1;
 }
 
 bool SoftwareRAID::isRaidPath(const QString &path)
@@ -84,8 +84,17 @@ protected:
     qint64 mappedSector(const QString &partitionPath, qint64 sector) const override;
 
 private:
+    struct Details;
+
+    SoftwareRAID(const QString& name, SoftwareRAID::Status status, const QString& iconName, const Details& details);
+
     static void scanSoftwareRAID(QList<Device*>& devices);
 
+    static Details readDetails(const QString& path);
+    static bool readSysfsDetails(const QString& path, Details& details);
+    static void readMdadmDetails(const QString& path, Details& details);
+    static qint64 logicalBlockSize(const QString& devicePath);
+
     static QString getDetail(const QString& path);
 
     static QString getRAIDConfiguration(const QString& configurationPath);
@@ -0,0 +1,204 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "core/scancache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+using namespace Qt::StringLiterals;
+
+// Bump whenever the layout of the stored records changes
+static constexpr int scanCacheVersion = 1;
+
+struct ScanCachePrivate
+{
+    QJsonObject m_Devices;
+    bool m_Modified = false;
+};
+
+static QString readSysfs(const QString& path)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly))
+        return QString();
+    return QString::fromLatin1(f.readAll()).trimmed();
+}
+
+static QString deviceName(const QString& deviceNode)
+{
+    if (!deviceNode.startsWith(u"/dev/"_s))
+        return QString();
+    QString name = deviceNode.mid(5);
+    return name.contains(u'/') ? QString() : name;
+}
+
+/** Reads the persistent cache from disk. A missing or outdated cache file yields an empty cache. */
+ScanCache::ScanCache() :
+    d(std::make_unique<ScanCachePrivate>())
+{
+    QFile cacheFile(fileName());
+    if (!cacheFile.open(QIODevice::ReadOnly))
+        return;
+
+    const QJsonObject root = QJsonDocument::fromJson(cacheFile.readAll()).object();
+    if (root[u"version"_s].toInt() == scanCacheVersion)
+        d->m_Devices = root[u"devices"_s].toObject();
+}
+
+ScanCache::~ScanCache()
+{
+}
+
+QJsonObject ScanCache::lookup(const QString& deviceNode) const
+{
+    const QJsonObject entry = d->m_Devices[deviceNode].toObject();
+    if (entry.isEmpty())
+        return QJsonObject();
+
+    const QString identity = deviceIdentity(deviceNode);
+    if (identity.isEmpty() || entry[u"identity"_s].toString() != identity)
+        return QJsonObject();
+
+    if (entry[u"generation"_s].toString() != deviceGeneration(deviceNode))
+        return QJsonObject();
+
+    return entry[u"record"_s].toObject();
+}
+
+void ScanCache::insert(const QString& deviceNode, const QJsonObject& record)
+{
+    const QString identity = deviceIdentity(deviceNode);
+    if (identity.isEmpty())
+        return;
+
+    QJsonObject entry;
+    entry[u"identity"_s] = identity;
+    entry[u"generation"_s] = deviceGeneration(deviceNode);
+    entry[u"record"_s] = record;
+    d->m_Devices[deviceNode] = entry;
+    d->m_Modified = true;
+}
+
+bool ScanCache::save() const
+{
+    if (!d->m_Modified)
+        return true;
+
+    const QString path = fileName();
+    if (!QDir().mkpath(QFileInfo(path).absolutePath()))
+        return false;
+
+    QJsonObject root;
+    root[u"version"_s] = scanCacheVersion;
+    root[u"devices"_s] = d->m_Devices;
+
+    QSaveFile cacheFile(path);
+    if (!cacheFile.open(QIODevice::WriteOnly)) {
+        qWarning() << "could not open scan cache" << path << "for writing";
+        return false;
+    }
+    cacheFile.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    if (!cacheFile.commit())
+        return false;
+
+    d->m_Modified = false;
+    return true;
+}
+
+QString ScanCache::fileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + u"/kpmcore/scancache.json"_s;
+}
+
+void ScanCache::clear()
+{
+    QFile::remove(fileName());
+}
+
+/** Identifies the physical device behind a device node.
+
+    The serial number (or WWID) together with the size survives reboots. Devices
+    without a serial, e.g. loop devices, fall back to the kernel's diskseq, which
+    is unique for the running system only.
+
+    @param deviceNode the device node (e.g. "/dev/sda")
+    @return the identity or an empty string if the device cannot be identified
+*/
+QString ScanCache::deviceIdentity(const QString& deviceNode)
+{
+    const QString name = deviceName(deviceNode);
+    if (name.isEmpty())
+        return QString();
+
+    const QString sysfsPath = u"/sys/block/"_s + name;
+    const QString size = readSysfs(sysfsPath + u"/size"_s);
+    if (size.isEmpty())
+        return QString();
+
+    QString serial = readSysfs(sysfsPath + u"/device/serial"_s);
+    if (serial.isEmpty())
+        serial = readSysfs(sysfsPath + u"/wwid"_s);
+    if (serial.isEmpty())
+        serial = readSysfs(sysfsPath + u"/device/wwid"_s);
+    if (!serial.isEmpty())
+        return u"serial:%1:%2"_s.arg(serial, size);
+
+    const QString diskseq = readSysfs(sysfsPath + u"/diskseq"_s);
+    if (!diskseq.isEmpty())
+        return u"diskseq:%1:%2"_s.arg(diskseq, size);
+
+    return QString();
+}
+
+/** Computes a change generation for a device.
+
+    The generation covers the size of the device, the start and size of every
+    partition the kernel knows about and the udev database entries of the device
+    and its partitions. udev rewrites those whenever it processes a change event,
+    which also happens after a file system was created, relabeled or resized.
+
+    @param deviceNode the device node (e.g. "/dev/sda")
+    @return a hash that changes whenever the device is modified
+*/
+QString ScanCache::deviceGeneration(const QString& deviceNode)
+{
+    const QString name = deviceName(deviceNode);
+    if (name.isEmpty())
+        return QString();
+
+    const QString sysfsPath = u"/sys/block/"_s + name;
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    auto addBlockDevice = [&hash] (const QString& path) {
+        const QString dev = readSysfs(path + u"/dev"_s);
+        const QFileInfo udevData(u"/run/udev/data/b"_s + dev);
+        hash.addData(QFileInfo(path).fileName().toLatin1());
+        hash.addData(dev.toLatin1());
+        hash.addData(readSysfs(path + u"/start"_s).toLatin1());
+        hash.addData(readSysfs(path + u"/size"_s).toLatin1());
+        hash.addData(QByteArray::number(udevData.size()));
+        hash.addData(QByteArray::number(udevData.lastModified().toMSecsSinceEpoch()));
+    };
+
+    addBlockDevice(sysfsPath);
+
+    const QDir sysfsDir(sysfsPath);
+    const QStringList entries = sysfsDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    for (const QString& entry : entries) {
+        if (QFileInfo::exists(sysfsDir.filePath(entry + u"/partition"_s)))
+            addBlockDevice(sysfsDir.filePath(entry));
+    }
+
+    return QString::fromLatin1(hash.result().toHex());
+}
@@ -0,0 +1,70 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_SCANCACHE_H
+#define KPMCORE_SCANCACHE_H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include <memory>
+
+#include <QJsonObject>
+#include <QString>
+
+struct ScanCachePrivate;
+
+/** Persistent cache of device scan results.
+
+    Backends can store what they probed for a device (partition table, file system
+    types, labels and UUIDs) in this cache and reuse it on the next scan
+    instead of running all the external tools again.
+
+    Each record is keyed by the identity of the device (its serial and size or, if
+    no serial is known, the kernel's diskseq) and stamped with a change generation
+    computed from the partition geometry in sysfs and the udev database entries of
+    the device and its partitions. Both are cheap to read, so a record is only
+    returned by lookup() if nothing on the device changed since it was stored.
+
+    @author kpmcore contributors
+*/
+class LIBKPMCORE_EXPORT ScanCache
+{
+public:
+    ScanCache();
+    ~ScanCache();
+
+public:
+    /**
+      * @param deviceNode the device node (e.g. "/dev/sda")
+      * @return the stored record for the device or an empty object if there is none
+      *         or the device changed since it was stored
+      */
+    QJsonObject lookup(const QString& deviceNode) const;
+
+    /**
+      * Store a record for a device, replacing any previous one.
+      * @param deviceNode the device node (e.g. "/dev/sda")
+      * @param record backend specific scan results
+      */
+    void insert(const QString& deviceNode, const QJsonObject& record);
+
+    /**
+      * Write the cache to disk if it was modified.
+      * @return true on success
+      */
+    bool save() const;
+
+    static QString fileName();
+    static void clear(); /**< remove the cache file */
+
+    static QString deviceIdentity(const QString& deviceNode);
+    static QString deviceGeneration(const QString& deviceNode);
+
+private:
+    std::unique_ptr<ScanCachePrivate> d;
+};
+
+#endif
@@ -32,6 +32,7 @@ SmartAttribute::SmartAttribute(const SmartAttributeParsedData& a) :
     m_Worst(a.worstValueValid() ? a.worstValue() : -1),
     m_Threshold(a.thresholdValid() ? a.threshold() : -1),
     m_Raw(getRaw(a.raw())),
+    m_RawValue(a.raw()),
     m_Assessment(getAssessment(a)),
     m_Value(getPrettyValue(a.prettyValue(), a.prettyUnit()))
 {
@@ -69,6 +69,9 @@ public:
     const QString& raw() const {
         return m_Raw;
     }
+    quint64 rawValue() const {
+        return m_RawValue;
+    }
     Assessment assessment() const {
         return m_Assessment;
     }
@@ -91,6 +94,7 @@ private:
     qint32 m_Worst;
     qint32 m_Threshold;
     QString m_Raw;
+    quint64 m_RawValue;
     Assessment m_Assessment;
     QString m_Value;
 };
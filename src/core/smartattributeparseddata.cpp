@@ -14,6 +14,7 @@
 #include <QJsonObject>
 #include <QMap>
 #include <QRegularExpression>
+#include <QStringList>
 #include <QVariant>
 #include <QVector>
 
@@ -25,7 +26,6 @@
 #define MSECOND_VALID_LONG_MAX (30ULL * 365ULL * 24ULL * 60ULL * 60ULL * 1000ULL)
 
 static QMap<qint32, SmartAttributeUnit> tableUnit();
-static SmartQuirk getQuirk(QString model, QString firmware);
 
 /** Creates a new SmartAttributeParsedData object.
     @param disk the reference to the disk that this attribute is allocated to
@@ -54,7 +54,7 @@ SmartAttributeParsedData::SmartAttributeParsedData(SmartDiskInformation *disk,
     m_Quirk(SmartQuirk::None)
 {
     if (disk)
-        m_Quirk = getQuirk(disk->model(), disk->firmware());
+        m_Quirk = disk->quirk();
 
     if (!jsonAttribute.isEmpty()) {
         QString id = QStringLiteral("id");
@@ -610,26 +610,65 @@ static const QVector<SmartAttributeParsedData::SmartQuirkDataBase> quirkDatabase
     return quirkDb;
 }
 
-static SmartQuirk getQuirk(QString model, QString firmware)
-{
-    const QVector<SmartAttributeParsedData::SmartQuirkDataBase> db = quirkDatabase();
-
-    QRegularExpression modelRegex;
-    QRegularExpression firmwareRegex;
+/** The quirk database with its regular expressions compiled.
 
-    for (const SmartAttributeParsedData::SmartQuirkDataBase &item : std::as_const(db)) {
-        if (!item.model.isEmpty()) {
-            modelRegex.setPattern(item.model);
-            QRegularExpressionMatch match = modelRegex.match(model);
-            if (!match.hasMatch())
-                continue;
+    The model patterns are also joined into one expression, so disks without
+    quirks, which are almost all of them, are rejected with a single match.
+*/
+struct CompiledQuirkDatabase
+{
+    struct Entry {
+        QRegularExpression model;
+        QRegularExpression firmware;
+        SmartQuirk quirk;
+    };
+
+    QList<Entry> entries;
+    QRegularExpression anyModel;
+
+    CompiledQuirkDatabase()
+    {
+        QStringList modelPatterns;
+        bool matchesAnyModel = false;
+
+        const QVector<SmartAttributeParsedData::SmartQuirkDataBase> db = quirkDatabase();
+        for (const SmartAttributeParsedData::SmartQuirkDataBase &item : db) {
+            Entry entry { QRegularExpression(item.model), QRegularExpression(item.firmware), item.quirk };
+            entry.model.optimize();
+            entry.firmware.optimize();
+            entries.append(entry);
+
+            if (item.model.isEmpty())
+                matchesAnyModel = true;
+            else
+                modelPatterns.append(QStringLiteral("(?:") + item.model + QLatin1Char(')'));
         }
-        if (!item.firmware.isEmpty()) {
-            firmwareRegex.setPattern(item.firmware);
-            QRegularExpressionMatch match = firmwareRegex.match(firmware);
-            if (!match.hasMatch())
-                continue;
+
+        if (!matchesAnyModel) {
+            anyModel.setPattern(modelPatterns.join(QLatin1Char('|')));
+            anyModel.optimize();
         }
+    }
+};
+
+/** Find the quirks of a disk.
+    @param model the disk model name
+    @param firmware the disk firmware version
+    @return the quirks of the first matching database entry
+*/
+SmartQuirk SmartAttributeParsedData::findQuirk(const QString &model, const QString &firmware)
+{
+    // Thread-safe initialization, QRegularExpression can be matched from several threads
+    static const CompiledQuirkDatabase db;
+
+    if (!db.anyModel.pattern().isEmpty() && !db.anyModel.match(model).hasMatch())
+        return SmartQuirk::None;
+
+    for (const CompiledQuirkDatabase::Entry &item : db.entries) {
+        if (!item.model.pattern().isEmpty() && !item.model.match(model).hasMatch())
+            continue;
+        if (!item.firmware.pattern().isEmpty() && !item.firmware.match(firmware).hasMatch())
+            continue;
         return item.quirk;
     }
 
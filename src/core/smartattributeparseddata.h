@@ -82,6 +82,9 @@ public:
 
     SmartAttributeParsedData(const SmartAttributeParsedData &other);
 
+public:
+    static SmartQuirk findQuirk(const QString &model, const QString &firmware);
+
 public:
     quint32 id() const
     {
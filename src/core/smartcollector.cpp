@@ -0,0 +1,92 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "core/smartcollector.h"
+#include "core/smartparser.h"
+
+#include "util/externalcommand.h"
+
+#include <QHash>
+#include <QThread>
+
+SmartCollector::SmartCollector(QObject* parent) :
+    QObject(parent),
+    m_Thread(nullptr),
+    m_MaxParallel(8)
+{
+}
+
+SmartCollector::~SmartCollector()
+{
+    if (m_Thread) {
+        m_Thread->wait();
+        delete m_Thread;
+    }
+}
+
+/** Read the SMART data of devices in a worker thread.
+
+    Devices whose data is still cached are not queried again. statusReady() is emitted
+    for every device and finished() once all of them were handled.
+
+    @param devicePaths the devices to read SMART data of
+    @return false if a refresh is still running
+*/
+bool SmartCollector::refresh(const QStringList& devicePaths)
+{
+    if (m_Thread)
+        return false;
+
+    const int parallel = maxParallel();
+    m_Thread = QThread::create([this, devicePaths, parallel] { collect(devicePaths, parallel); });
+    connect(m_Thread, &QThread::finished, this, [this] {
+        m_Thread->deleteLater();
+        m_Thread = nullptr;
+        Q_EMIT finished();
+    });
+    m_Thread->start();
+
+    return true;
+}
+
+/** @return true if a refresh is running */
+bool SmartCollector::isRunning() const
+{
+    return m_Thread != nullptr;
+}
+
+/* Runs in the worker thread */
+void SmartCollector::collect(const QStringList& devicePaths, int maxParallel)
+{
+    QStringList stale;
+    for (const QString& devicePath : devicePaths)
+        if (!SmartParser::isCached(devicePath))
+            stale.append(devicePath);
+
+    QHash<QString, QByteArray> outputs;
+    if (!stale.isEmpty()) {
+        // The helper appends each device to the arguments
+        ExternalCommand smartctl(QStringLiteral("smartctl"), SmartParser::smartctlArguments());
+        const QList<QVariantMap> results = smartctl.runForEach(stale, maxParallel);
+        for (qsizetype i = 0; i < results.size(); ++i) {
+            const QVariantMap& result = results[i];
+            if (!result[QStringLiteral("success")].toBool())
+                continue;
+
+            const bool valid = SmartParser::isValidExitCode(result[QStringLiteral("exitCode")].toInt());
+            const QByteArray output = valid ? result[QStringLiteral("output")].toByteArray() : QByteArray();
+            outputs.insert(stale[i], output);
+            SmartParser::cacheOutput(stale[i], output);
+        }
+    }
+
+    for (const QString& devicePath : devicePaths) {
+        const auto it = outputs.constFind(devicePath);
+        Q_EMIT statusReady(devicePath, it != outputs.cend() ? std::make_shared<SmartStatus>(devicePath, *it) : std::make_shared<SmartStatus>(devicePath));
+    }
+}
+
+#include "moc_smartcollector.cpp"
@@ -0,0 +1,72 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_SMARTCOLLECTOR_H
+#define KPMCORE_SMARTCOLLECTOR_H
+
+#include "util/libpartitionmanagerexport.h"
+#include "core/smartstatus.h"
+
+#include <QObject>
+#include <QStringList>
+
+#include <memory>
+
+class QThread;
+
+/** Reads SMART data of many disks in the background.
+
+    smartctl mostly waits for the disk, so running it for one disk after the other
+    takes a long time on machines with many disks. SmartCollector lets the helper run
+    smartctl for up to maxParallel() disks at the same time in a worker thread and
+    reports each SmartStatus with a signal.
+
+    The reported SmartStatus objects are made from the output read in parallel. If
+    SmartStatus::setCacheTimeout() enabled the cache, the output is also kept there,
+    so disks refreshed within the timeout are not queried again.
+
+    @author kpmcore contributors
+*/
+class LIBKPMCORE_EXPORT SmartCollector : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(SmartCollector)
+
+public:
+    explicit SmartCollector(QObject* parent = nullptr);
+    ~SmartCollector() override;
+
+public:
+    bool refresh(const QStringList& devicePaths);
+    bool isRunning() const;
+
+    int maxParallel() const {
+        return m_MaxParallel; /**< @return the maximum number of smartctl processes running at the same time */
+    }
+    void setMaxParallel(int n) {
+        m_MaxParallel = qMax(1, n); /**< @param n the maximum number of smartctl processes running at the same time */
+    }
+
+Q_SIGNALS:
+    /** Emitted for each device of a refresh.
+        @param devicePath the device
+        @param status the SMART data of the device, check SmartStatus::isValid(). Hand it
+                      to Device::setSmartStatus() to use it for the Device.
+    */
+    void statusReady(const QString& devicePath, std::shared_ptr<SmartStatus> status);
+
+    /** Emitted after statusReady() was emitted for all devices of a refresh. */
+    void finished();
+
+private:
+    void collect(const QStringList& devicePaths, int maxParallel);
+
+private:
+    QThread* m_Thread;
+    int m_MaxParallel;
+};
+
+#endif
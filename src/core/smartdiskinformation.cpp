@@ -27,10 +27,17 @@ SmartDiskInformation::SmartDiskInformation() :
     m_BadAttributeNow(false),
     m_BadAttributeInThePast(false),
     m_SelfTestExecutionStatus(SmartStatus::SelfTestStatus::Success),
-    m_Overall(SmartStatus::Overall::Bad)
+    m_Overall(SmartStatus::Overall::Bad),
+    m_Quirk(SmartQuirk::None)
 {
 }
 
+/** Look up the SMART quirks of the disk model and firmware, needs to be called before attributes are parsed */
+void SmartDiskInformation::updateQuirk()
+{
+    m_Quirk = SmartAttributeParsedData::findQuirk(model(), firmware());
+}
+
 /** Update the number of bad sectors based on reallocated sector count and current pending sector attributes data */
 void SmartDiskInformation::updateBadSectors()
 {
@@ -9,12 +9,11 @@
 #define KPMCORE_SMARTDISKINFORMATION_H
 
 #include "core/smartstatus.h"
+#include "core/smartattributeparseddata.h"
 
 #include <QList>
 #include <QString>
 
-class SmartAttributeParsedData;
-
 /** Disk information retrieved by SMART.
 
     It includes a list with your SMART attributes.
@@ -37,6 +36,8 @@ public:
 
     bool updatePowerCycle();
 
+    void updateQuirk();
+
     SmartAttributeParsedData *findAttribute(quint32 id);
 
 public:
@@ -95,6 +96,11 @@ public:
         return m_PowerCycles;    /**< @return quantity of power cycles */
     }
 
+    SmartQuirk quirk() const
+    {
+        return m_Quirk;    /**< @return the SMART quirks of the disk model and firmware */
+    }
+
     QList<SmartAttributeParsedData> attributes() const
     {
         return m_Attributes;    /**< @return a list that contains the disk SMART attributes */
@@ -158,6 +164,7 @@ private:
     bool m_BadAttributeInThePast;
     SmartStatus::SelfTestStatus m_SelfTestExecutionStatus;
     SmartStatus::Overall m_Overall;
+    SmartQuirk m_Quirk;
     QList<SmartAttributeParsedData> m_Attributes;
 };
 
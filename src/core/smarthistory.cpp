@@ -0,0 +1,343 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "core/smarthistory.h"
+#include "core/smartstatus.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <QTimeZone>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/* A history file starts with fileMagic followed by records:
+ *
+ *   varint  length of the rest of the record
+ *   zigzag  seconds since the previous record, since the epoch for the first one
+ *   varint  number of values
+ *   n times:
+ *     varint  metric
+ *     zigzag  difference to the previous value of the metric, to 0 for the first one
+ *
+ * Metrics that did not change are not stored. A record that was cut short, e.g. by a
+ * crash, ends the history and is overwritten by the next append.
+ */
+static const QByteArray fileMagic = QByteArrayLiteral("KPMSMRT1");
+static const QString fileSuffix = QStringLiteral(".smarthistory");
+
+static void writeVarint(QByteArray& data, quint64 value)
+{
+    while (value >= 0x80) {
+        data.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    data.append(static_cast<char>(value));
+}
+
+static void writeZigzag(QByteArray& data, qint64 value)
+{
+    writeVarint(data, (static_cast<quint64>(value) << 1) ^ static_cast<quint64>(value >> 63));
+}
+
+static bool readVarint(const QByteArray& data, qsizetype& pos, qsizetype end, quint64& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < end; shift += 7) {
+        const quint8 byte = static_cast<quint8>(data[pos++]);
+        value |= static_cast<quint64>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static bool readZigzag(const QByteArray& data, qsizetype& pos, qsizetype end, qint64& value)
+{
+    quint64 encoded;
+    if (!readVarint(data, pos, end, encoded))
+        return false;
+    value = static_cast<qint64>(encoded >> 1) ^ -static_cast<qint64>(encoded & 1);
+    return true;
+}
+
+/** Replays a history file and calls f(time, values) with the state after each record.
+    @return the size of the data up to the last complete record or -1 if it is no history file
+*/
+template <typename F>
+static qint64 replay(const QByteArray& data, F f)
+{
+    if (!data.startsWith(fileMagic))
+        return -1;
+
+    qint64 time = 0;
+    QHash<quint32, qint64> values;
+
+    qsizetype pos = fileMagic.size();
+    while (pos < data.size()) {
+        qsizetype recordPos = pos;
+        quint64 length;
+        if (!readVarint(data, recordPos, data.size(), length) || length > static_cast<quint64>(data.size() - recordPos))
+            break;
+        const qsizetype end = recordPos + static_cast<qsizetype>(length);
+
+        qint64 timeDelta;
+        quint64 count;
+        if (!readZigzag(data, recordPos, end, timeDelta) || !readVarint(data, recordPos, end, count))
+            break;
+
+        QHash<quint32, qint64> next = values;
+        bool complete = true;
+        for (quint64 i = 0; i < count && complete; ++i) {
+            quint64 metric;
+            qint64 delta;
+            complete = readVarint(data, recordPos, end, metric) && readZigzag(data, recordPos, end, delta);
+            if (complete)
+                next[static_cast<quint32>(metric)] += delta;
+        }
+        if (!complete || recordPos != end)
+            break;
+
+        time += timeDelta;
+        values = std::move(next);
+        pos = end;
+        f(time, values);
+    }
+
+    return pos;
+}
+
+/** Creates a history stored in a directory.
+    @param directory the directory with one history file per disk, created on the first append
+*/
+SmartHistory::SmartHistory(const QString& directory) :
+    m_Directory(directory)
+{
+}
+
+/** Append the current values of a disk.
+    @param status the SMART data of the disk
+    @param time the time the data was read
+    @return true on success
+*/
+bool SmartHistory::append(const SmartStatus& status, const QDateTime& time)
+{
+    if (!status.isValid())
+        return false;
+
+    QHash<quint32, qint64> values;
+    for (const SmartAttribute& attribute : status.attributes())
+        values.insert(attribute.id(), static_cast<qint64>(attribute.rawValue()));
+    values.insert(Temperature, static_cast<qint64>(status.temp()));
+    values.insert(BadSectors, static_cast<qint64>(status.badSectors()));
+    values.insert(PoweredOn, static_cast<qint64>(status.poweredOn()));
+    values.insert(PowerCycles, static_cast<qint64>(status.powerCycles()));
+
+    return append(diskId(status), values, time);
+}
+
+/** Append values of a disk.
+    @param diskId the identifier of the disk, see diskId()
+    @param values the values by metric
+    @param time the time the values were read
+    @return true on success
+*/
+bool SmartHistory::append(const QString& diskId, const QHash<quint32, qint64>& values, const QDateTime& time)
+{
+    if (diskId.isEmpty() || !time.isValid())
+        return false;
+
+    DiskState& state = m_States[diskId];
+    if (!load(diskId, state))
+        return false;
+
+    QByteArray payload;
+    const qint64 seconds = time.toSecsSinceEpoch();
+    writeZigzag(payload, seconds - state.time);
+
+    QByteArray changes;
+    quint64 count = 0;
+    for (auto it = values.cbegin(); it != values.cend(); ++it) {
+        const qint64 delta = it.value() - state.values.value(it.key());
+        if (delta == 0 && state.values.contains(it.key()))
+            continue;
+        writeVarint(changes, it.key());
+        writeZigzag(changes, delta);
+        ++count;
+    }
+    writeVarint(payload, count);
+    payload += changes;
+
+    QByteArray record;
+    writeVarint(record, payload.size());
+    record += payload;
+
+    if (!QDir().mkpath(m_Directory))
+        return false;
+
+    QFile file(fileName(diskId));
+    if (!file.open(QIODevice::ReadWrite)) {
+        qWarning() << "Cannot open SMART history" << file.fileName() << file.errorString();
+        return false;
+    }
+
+    // Drop an incomplete record left by an interrupted append
+    if (state.validSize == 0) {
+        file.resize(0);
+        if (file.write(fileMagic) != fileMagic.size())
+            return false;
+        state.validSize = fileMagic.size();
+    }
+    else if (file.size() != state.validSize)
+        file.resize(state.validSize);
+
+    if (!file.seek(state.validSize) || file.write(record) != record.size()) {
+        qWarning() << "Cannot write SMART history" << file.fileName() << file.errorString();
+        state.loaded = false;
+        return false;
+    }
+
+    state.validSize += record.size();
+    state.time = seconds;
+    for (auto it = values.cbegin(); it != values.cend(); ++it)
+        state.values.insert(it.key(), it.value());
+
+    return true;
+}
+
+/** @return the identifiers of all disks with a history */
+QStringList SmartHistory::disks() const
+{
+    QStringList ids;
+    const QStringList files = QDir(m_Directory).entryList({ QLatin1Char('*') + fileSuffix }, QDir::Files, QDir::Name);
+    for (const QString& file : files)
+        ids.append(file.chopped(fileSuffix.size()));
+    return ids;
+}
+
+/** Get the values of a metric over time.
+    @param diskId the identifier of the disk
+    @param metric a SMART attribute id or a Metric
+    @param from the first time to include, all of the history if invalid
+    @param to the last time to include, all of the history if invalid
+    @return one sample per record since the metric was first stored
+*/
+QList<SmartHistory::Sample> SmartHistory::samples(const QString& diskId, quint32 metric, const QDateTime& from, const QDateTime& to) const
+{
+    QList<Sample> result;
+
+    QFile file(fileName(diskId));
+    if (!file.open(QIODevice::ReadOnly))
+        return result;
+
+    const qint64 first = from.isValid() ? from.toSecsSinceEpoch() : std::numeric_limits<qint64>::min();
+    const qint64 last = to.isValid() ? to.toSecsSinceEpoch() : std::numeric_limits<qint64>::max();
+
+    replay(file.readAll(), [&] (qint64 time, const QHash<quint32, qint64>& values) {
+        const auto it = values.constFind(metric);
+        if (it != values.cend() && time >= first && time <= last)
+            result.append({ QDateTime::fromSecsSinceEpoch(time, QTimeZone::UTC), it.value() });
+    });
+
+    return result;
+}
+
+/** Get how fast a metric grows, e.g. the number of new reallocated sectors per week.
+    @return the change per week between the first and last sample in the range or NaN if
+            there are less than two samples
+*/
+double SmartHistory::ratePerWeek(const QString& diskId, quint32 metric, const QDateTime& from, const QDateTime& to) const
+{
+    constexpr double secondsPerWeek = 7 * 24 * 3600;
+
+    const QList<Sample> s = samples(diskId, metric, from, to);
+    if (s.size() < 2)
+        return std::nan("");
+
+    const qint64 seconds = s.first().time.secsTo(s.last().time);
+    if (seconds <= 0)
+        return std::nan("");
+
+    return static_cast<double>(s.last().value - s.first().value) * secondsPerWeek / seconds;
+}
+
+/** Get a percentile of a metric, e.g. the 95th percentile of the temperature.
+    @param p the percentile from 0 to 100
+    @return the value below or at which p percent of the samples are or -1 if there are none
+*/
+qint64 SmartHistory::percentile(const QString& diskId, quint32 metric, double p, const QDateTime& from, const QDateTime& to) const
+{
+    const QList<Sample> s = samples(diskId, metric, from, to);
+    if (s.isEmpty())
+        return -1;
+
+    QList<qint64> values;
+    values.reserve(s.size());
+    for (const Sample& sample : s)
+        values.append(sample.value);
+
+    // nearest rank
+    const qsizetype rank = std::clamp<qsizetype>(static_cast<qsizetype>(std::ceil(p / 100.0 * values.size())), 1, values.size());
+    std::nth_element(values.begin(), values.begin() + rank - 1, values.end());
+    return values[rank - 1];
+}
+
+/** @return an identifier of the disk that does not change with its device node */
+QString SmartHistory::diskId(const SmartStatus& status)
+{
+    static const QRegularExpression unsafe(QStringLiteral("[^A-Za-z0-9._-]+"));
+
+    QString id = status.modelName() + QLatin1Char('_') + status.serial();
+    id.replace(unsafe, QStringLiteral("_"));
+    return id;
+}
+
+/** @return the directory histories are stored in by default */
+QString SmartHistory::defaultDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QStringLiteral("/kpmcore/smart-history");
+}
+
+QString SmartHistory::fileName(const QString& diskId) const
+{
+    return m_Directory + QLatin1Char('/') + diskId + fileSuffix;
+}
+
+/* Replays the file once per SmartHistory to know the values new records are relative to */
+bool SmartHistory::load(const QString& diskId, DiskState& state) const
+{
+    if (state.loaded)
+        return true;
+
+    state = DiskState();
+
+    QFile file(fileName(diskId));
+    if (file.exists()) {
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "Cannot read SMART history" << file.fileName() << file.errorString();
+            return false;
+        }
+
+        const qint64 validSize = replay(file.readAll(), [&state] (qint64 time, const QHash<quint32, qint64>& values) {
+            state.time = time;
+            state.values = values;
+        });
+
+        // Not a history file, do not overwrite it
+        if (validSize < 0 && file.size() > 0) {
+            qWarning() << "Not a SMART history" << file.fileName();
+            return false;
+        }
+        state.validSize = qMax<qint64>(validSize, 0);
+    }
+
+    state.loaded = true;
+    return true;
+}
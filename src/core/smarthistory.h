@@ -0,0 +1,88 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_SMARTHISTORY_H
+#define KPMCORE_SMARTHISTORY_H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class SmartStatus;
+
+/** Time series of SMART data kept on disk.
+
+    Every refresh of a disk's SmartStatus can be appended to a per-disk file. The
+    file is append-only and stores only the values that changed since the previous
+    record, as variable length deltas, so a record of a healthy disk takes a few
+    bytes. This is enough to keep years of hourly samples for a whole fleet.
+
+    Queries replay the file and return samples of one metric or derive trends like
+    the growth of reallocated sectors per week or temperature percentiles.
+
+    A metric is a SMART attribute id (1-255) or one of the values SmartStatus
+    computes, see Metric.
+
+    Only one SmartHistory should append to a directory at a time.
+
+    @author kpmcore contributors
+*/
+class LIBKPMCORE_EXPORT SmartHistory
+{
+public:
+    /** Values of SmartStatus stored next to the raw values of the attributes */
+    enum Metric : quint32 {
+        Temperature = 0x100,    /**< in millikelvin */
+        BadSectors = 0x101,
+        PoweredOn = 0x102,      /**< in milliseconds */
+        PowerCycles = 0x103,
+    };
+
+    struct Sample {
+        QDateTime time;
+        qint64 value;
+    };
+
+public:
+    explicit SmartHistory(const QString& directory = defaultDirectory());
+
+public:
+    bool append(const SmartStatus& status, const QDateTime& time = QDateTime::currentDateTimeUtc());
+    bool append(const QString& diskId, const QHash<quint32, qint64>& values, const QDateTime& time);
+
+    QStringList disks() const;
+    QList<Sample> samples(const QString& diskId, quint32 metric, const QDateTime& from = QDateTime(), const QDateTime& to = QDateTime()) const;
+    double ratePerWeek(const QString& diskId, quint32 metric, const QDateTime& from = QDateTime(), const QDateTime& to = QDateTime()) const;
+    qint64 percentile(const QString& diskId, quint32 metric, double p, const QDateTime& from = QDateTime(), const QDateTime& to = QDateTime()) const;
+
+    const QString& directory() const {
+        return m_Directory; /**< @return the directory with the history files */
+    }
+
+    static QString diskId(const SmartStatus& status);
+    static QString defaultDirectory();
+
+private:
+    struct DiskState {
+        bool loaded = false;
+        qint64 time = 0;            /**< seconds since epoch of the last record */
+        QHash<quint32, qint64> values;
+        qint64 validSize = 0;       /**< size of the file up to the last complete record */
+    };
+
+    QString fileName(const QString& diskId) const;
+    bool load(const QString& diskId, DiskState& state) const;
+
+private:
+    QString m_Directory;
+    QHash<QString, DiskState> m_States;
+};
+
+#endif
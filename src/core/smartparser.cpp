@@ -16,17 +16,46 @@
 #include <utility>
 
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QString>
 
+namespace {
+struct CachedOutput
+{
+    QByteArray output;      // empty if smartctl failed for the device
+    QElapsedTimer age;
+};
+
+QMutex cacheMutex;
+QHash<QString, CachedOutput> outputCache;
+int outputCacheTimeout = 0;
+}
+
 /** Creates a new SmartParser object
     @param device_path device path that indicates the device that SMART must analyze
 */
 SmartParser::SmartParser(const QString &device_path) :
     m_DevicePath(device_path),
-    m_DiskInformation(nullptr)
+    m_DiskInformation(nullptr),
+    m_Prefetched(false)
+{
+}
+
+/** Creates a new SmartParser object for output of smartctl that was already read
+    @param device_path device path that indicates the device that SMART must analyze
+    @param output the JSON output of smartctl or an empty QByteArray if it failed
+*/
+SmartParser::SmartParser(const QString &device_path, const QByteArray &output) :
+    m_DevicePath(device_path),
+    m_SmartOutput(QJsonDocument::fromJson(output)),
+    m_DiskInformation(nullptr),
+    m_Prefetched(true)
 {
 }
 
@@ -93,6 +122,8 @@ bool SmartParser::init()
 
     m_DiskInformation->setSelfTestExecutionStatus(static_cast<SmartStatus::SelfTestStatus>(selfTestStatus[value].toInt()));
 
+    m_DiskInformation->updateQuirk();
+
     loadAttributes();
 
     m_DiskInformation->updateBadSectors();
@@ -111,26 +142,93 @@ bool SmartParser::init()
     return true;
 }
 
+/** Store the output of smartctl for a device so parsers created before the cache
+    timeout elapsed do not run smartctl again.
+    @param device_path the device smartctl was run for
+    @param output the JSON output of smartctl or an empty QByteArray if it failed
+*/
+void SmartParser::cacheOutput(const QString &device_path, const QByteArray &output)
+{
+    QMutexLocker locker(&cacheMutex);
+    if (outputCacheTimeout <= 0)
+        return;
+
+    CachedOutput &entry = outputCache[device_path];
+    entry.output = output;
+    entry.age.start();
+}
+
+/** @return true if the cache holds output of smartctl for the device that is not older than the cache timeout */
+bool SmartParser::isCached(const QString &device_path)
+{
+    QMutexLocker locker(&cacheMutex);
+    const auto it = outputCache.constFind(device_path);
+    return it != outputCache.cend() && !it->age.hasExpired(outputCacheTimeout);
+}
+
+/** @param msecs how long the output of smartctl is reused, 0 (the default) disables the cache */
+void SmartParser::setCacheTimeout(int msecs)
+{
+    QMutexLocker locker(&cacheMutex);
+    outputCacheTimeout = msecs;
+    if (msecs <= 0)
+        outputCache.clear();
+}
+
+/** @return how long the output of smartctl is reused in milliseconds */
+int SmartParser::cacheTimeout()
+{
+    QMutexLocker locker(&cacheMutex);
+    return outputCacheTimeout;
+}
+
 /** Run smartctl command and recover its output */
 void SmartParser::loadSmartOutput()
 {
-    if (m_SmartOutput.isEmpty()) {
-        ExternalCommand smartctl(QStringLiteral("smartctl"), { QStringLiteral("--all"), QStringLiteral("--json"), devicePath() });
-
-        // Exit status of smartctl is a bitfield, check that bits 0 and 1 are not set:
-        //  - bit 0: command line did not parse;
-        //  - bit 1: device open failed.
-        // See `man 8 smartctl` for more details.
-        if (smartctl.run() && (smartctl.exitCode() & 1) == 0 && (smartctl.exitCode() & 2) == 0) {
+    if (m_SmartOutput.isEmpty() && !m_Prefetched) {
+        {
+            QMutexLocker locker(&cacheMutex);
+            const auto it = outputCache.constFind(devicePath());
+            if (it != outputCache.cend() && !it->age.hasExpired(outputCacheTimeout)) {
+                m_SmartOutput = QJsonDocument::fromJson(it->output);
+                return;
+            }
+        }
+
+        ExternalCommand smartctl(QStringLiteral("smartctl"), smartctlArguments() << devicePath());
+
+        if (smartctl.run() && isValidExitCode(smartctl.exitCode())) {
             QByteArray output = smartctl.rawOutput();
 
             m_SmartOutput = QJsonDocument::fromJson(output);
+            cacheOutput(devicePath(), output);
         }
-        else
+        else {
             qDebug() << "smartctl initialization failed for " << devicePath() << ": " << strerror(errno);
+
+            // Do not ask devices without SMART support again until the cache expires
+            if (smartctl.exitCode() > 0)
+                cacheOutput(devicePath(), QByteArray());
+        }
     }
 }
 
+/** @return the options of smartctl to get all SMART data of a device, the device has to be appended */
+QStringList SmartParser::smartctlArguments()
+{
+    return { QStringLiteral("--all"), QStringLiteral("--json") };
+}
+
+/** Exit status of smartctl is a bitfield, check that bits 0 and 1 are not set:
+     - bit 0: command line did not parse;
+     - bit 1: device open failed.
+    See `man 8 smartctl` for more details.
+*/
+bool SmartParser::isValidExitCode(int exitCode)
+{
+    return (exitCode & 1) == 0 && (exitCode & 2) == 0;
+}
+
 /** Load SMART disk attributes from JSON data */
 void SmartParser::loadAttributes()
 {
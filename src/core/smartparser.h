@@ -7,8 +7,10 @@
 #ifndef KPMCORE_SMARTPARSER_H
 #define KPMCORE_SMARTPARSER_H
 
+#include <QByteArray>
 #include <QJsonDocument>
 #include <QString>
+#include <QStringList>
 
 class SmartDiskInformation;
 
@@ -22,11 +24,20 @@ class SmartParser
 {
 public:
     explicit SmartParser(const QString &device_path);
+    SmartParser(const QString &device_path, const QByteArray &output);
     ~SmartParser();
 
 public:
     bool init();
 
+    static void cacheOutput(const QString &device_path, const QByteArray &output);
+    static bool isCached(const QString &device_path);
+    static void setCacheTimeout(int msecs);
+    static int cacheTimeout();
+
+    static QStringList smartctlArguments();
+    static bool isValidExitCode(int exitCode);
+
 public:
     const QString &devicePath() const
     {
@@ -47,6 +58,7 @@ private:
     const QString m_DevicePath;
     QJsonDocument m_SmartOutput;
     SmartDiskInformation *m_DiskInformation;
+    bool m_Prefetched;
 
 };
 
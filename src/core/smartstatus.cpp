@@ -41,10 +41,41 @@ SmartStatus::SmartStatus(const QString &device_path) :
     update();
 }
 
+/** Creates a SmartStatus from output of smartctl that was already read, e.g. by SmartCollector.
+    @param device_path the device the output is for
+    @param smartOutput the JSON output of smartctl or an empty QByteArray if it failed
+*/
+SmartStatus::SmartStatus(const QString &device_path, const QByteArray &smartOutput) :
+    m_DevicePath(device_path),
+    m_InitSuccess(false),
+    m_Status(false),
+    m_ModelName(),
+    m_Serial(),
+    m_Firmware(),
+    m_Overall(Overall::Bad),
+    m_SelfTestStatus(SelfTestStatus::Success),
+    m_Temp(0),
+    m_BadSectors(0),
+    m_PowerCycles(0),
+    m_PoweredOn(0)
+{
+    SmartParser parser(devicePath(), smartOutput);
+    update(parser);
+}
+
+/** Read the SMART data of the device.
+
+    This runs smartctl unless the output of smartctl is cached, which only happens if
+    a cacheTimeout() was set.
+*/
 void SmartStatus::update()
 {
     SmartParser parser(devicePath());
+    update(parser);
+}
 
+void SmartStatus::update(SmartParser &parser)
+{
     if (!parser.init()) {
         qDebug() << "error during smart output parsing for " << devicePath() << ": " << strerror(errno);
         return;
@@ -141,6 +172,18 @@ QString SmartStatus::overallAssessmentToString(Overall o)
 
 }
 
+/** @param msecs how long SMART data of a device is reused, 0 (the default) always runs smartctl */
+void SmartStatus::setCacheTimeout(int msecs)
+{
+    SmartParser::setCacheTimeout(msecs);
+}
+
+/** @return how long SMART data of a device is reused in milliseconds */
+int SmartStatus::cacheTimeout()
+{
+    return SmartParser::cacheTimeout();
+}
+
 void SmartStatus::addAttributes(QList<SmartAttributeParsedData> attr)
 {
     m_Attributes.clear();
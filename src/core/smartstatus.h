@@ -16,11 +16,13 @@
 #include "core/smartattribute.h"
 
 #include <QtGlobal>
+#include <QByteArray>
 #include <QString>
 #include <QList>
 
 struct SkSmartAttributeParsedData;
 struct SkDisk;
+class SmartParser;
 
 class LIBKPMCORE_EXPORT SmartStatus
 {
@@ -52,6 +54,7 @@ public:
 
 public:
     explicit SmartStatus(const QString &device_path);
+    SmartStatus(const QString &device_path, const QByteArray &smartOutput);
 
 public:
     void update();
@@ -115,7 +118,12 @@ public:
     static QString overallAssessmentToString(Overall o);
     static QString selfTestStatusToString(SmartStatus::SelfTestStatus s);
 
+    static void setCacheTimeout(int msecs);
+    static int cacheTimeout();
+
 private:
+    void update(SmartParser &parser);
+
     void setStatus(bool s)
     {
         m_Status = s;
@@ -0,0 +1,140 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "core/usedspacereader.h"
+#include "core/device.h"
+#include "core/operationstack.h"
+#include "core/partition.h"
+
+#include "fs/filesystem.h"
+#include "fs/filesystemfactory.h"
+
+#include <QMutexLocker>
+#include <QReadLocker>
+#include <QtMath>
+
+static thread_local UsedSpaceReader* currentReader = nullptr;
+
+/** @param ostack the OperationStack whose preview Devices results are applied to */
+UsedSpaceReader::UsedSpaceReader(OperationStack& ostack, QObject* parent) :
+    QThread(parent),
+    m_OperationStack(ostack),
+    m_Generation(0)
+{
+}
+
+UsedSpaceReader::~UsedSpaceReader()
+{
+    cancel();
+}
+
+/** Queue a Partition to read the used space of its FileSystem.
+    @param p the Partition; it is not accessed after this returns
+*/
+void UsedSpaceReader::enqueue(Partition& p)
+{
+    Job job { p.devicePath(), p.partitionPath(), p.firstSector(), std::shared_ptr<FileSystem>(FileSystemFactory::create(p.fileSystem())), p.deviceNode() };
+
+    QMutexLocker locker(&m_QueueMutex);
+    m_Queue.append(job);
+}
+
+/** Drop all queued Partitions and wait for the thread to finish.
+
+    Results that were read but not applied yet are discarded.
+*/
+void UsedSpaceReader::cancel()
+{
+    {
+        QMutexLocker locker(&m_QueueMutex);
+        m_Queue.clear();
+    }
+    ++m_Generation;
+    requestInterruption();
+    wait();
+}
+
+/** Discard the results of all reads that already started, e.g. because Operations changed the preview. */
+void UsedSpaceReader::invalidate()
+{
+    ++m_Generation;
+}
+
+/** @return true if nothing is queued and the thread is not running */
+bool UsedSpaceReader::isIdle() const
+{
+    QMutexLocker locker(&m_QueueMutex);
+    return m_Queue.isEmpty() && !isRunning();
+}
+
+/** @return the reader backends should queue partitions on in this thread or nullptr if used space is read right away */
+UsedSpaceReader* UsedSpaceReader::current()
+{
+    return currentReader;
+}
+
+void UsedSpaceReader::setCurrent(UsedSpaceReader* reader)
+{
+    currentReader = reader;
+}
+
+void UsedSpaceReader::run()
+{
+    while (!isInterruptionRequested()) {
+        Job job;
+        {
+            QMutexLocker locker(&m_QueueMutex);
+            if (m_Queue.isEmpty())
+                break;
+            job = m_Queue.takeFirst();
+        }
+
+        const int generation = m_Generation;
+
+        const qint64 usedBytes = job.fileSystem->readUsedCapacity(job.deviceNode);
+        if (usedBytes < 0)
+            continue;
+
+        QMetaObject::invokeMethod(this, [this, job, usedBytes, generation] { apply(job, usedBytes, generation); }, Qt::QueuedConnection);
+    }
+}
+
+/** @return the Partition in the preview a Job was queued for or nullptr if it is gone */
+Partition* UsedSpaceReader::findPartition(const Job& job) const
+{
+    for (Device *d : std::as_const(m_OperationStack.previewDevices())) {
+        if (d->deviceNode() != job.devicePath || d->partitionTable() == nullptr)
+            continue;
+
+        Partition* p = d->partitionTable()->findPartitionBySector(job.firstSector, PartitionRole(PartitionRole::Any));
+        if (p && p->partitionPath() == job.partitionPath && p->firstSector() == job.firstSector &&
+                !p->roles().has(PartitionRole::Unallocated) && p->fileSystem().type() == job.fileSystem->type())
+            return p;
+    }
+
+    return nullptr;
+}
+
+void UsedSpaceReader::apply(const Job& job, qint64 usedBytes, int generation)
+{
+    // Devices were rescanned or Operations changed the preview in the meantime
+    if (generation != m_Generation)
+        return;
+
+    QReadLocker lockDevices(&m_OperationStack.lock());
+
+    Partition* p = findPartition(job);
+    if (p == nullptr || m_OperationStack.contains(p))
+        return;
+
+    FileSystem& fs = p->fileSystem();
+    if (fs.sectorSize() > 0)
+        fs.setSectorsUsed(qCeil(usedBytes / static_cast<double>(fs.sectorSize())));
+
+    Q_EMIT sectorsUsedRead(p);
+}
+
+#include "moc_usedspacereader.cpp"
@@ -0,0 +1,87 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_USEDSPACEREADER_H
+#define KPMCORE_USEDSPACEREADER_H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include <atomic>
+#include <memory>
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+
+class FileSystem;
+class OperationStack;
+class Partition;
+
+/** Thread to read the used space of file systems after a scan.
+
+    Reading the used space of an unmounted file system means running its tools
+    (dumpe2fs, xfs_db, ntfsinfo, ...) which dominates the time of a scan. When
+    scanning with ScanFlag::deferUsedSpace, backends hand these partitions to the
+    current UsedSpaceReader instead, so the device tree is available right away,
+    and the reader fills in the used space afterwards.
+
+    The reader works on copies of the FileSystems and remembers Partitions by their
+    device and path. Results are delivered to the thread the reader object lives in,
+    usually the one that created the DeviceScanner. There the Partition is looked up
+    in the OperationStack's preview Devices again and its FileSystem updated, unless
+    the Partition is gone, Operations changed since the read started or a pending
+    Operation involves it. Updates are announced with sectorsUsedRead().
+
+    @author kpmcore contributors
+*/
+class LIBKPMCORE_EXPORT UsedSpaceReader : public QThread
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(UsedSpaceReader)
+
+public:
+    explicit UsedSpaceReader(OperationStack& ostack, QObject* parent = nullptr);
+    ~UsedSpaceReader() override;
+
+public:
+    void enqueue(Partition& p);
+    void cancel();
+    void invalidate();
+    bool isIdle() const;
+
+    static UsedSpaceReader* current();
+    static void setCurrent(UsedSpaceReader* reader);
+
+Q_SIGNALS:
+    /** Emitted after the used space of a file system was read.
+        @param p the Partition the FileSystem is on
+    */
+    void sectorsUsedRead(Partition* p);
+
+protected:
+    void run() override;
+
+private:
+    struct Job {
+        QString devicePath;         /**< node of the Device the Partition is on */
+        QString partitionPath;
+        qint64 firstSector;
+        std::shared_ptr<FileSystem> fileSystem; /**< copy of the Partition's FileSystem to read with */
+        QString deviceNode;         /**< node to read the FileSystem from */
+    };
+
+    Partition* findPartition(const Job& job) const;
+    void apply(const Job& job, qint64 usedBytes, int generation);
+
+private:
+    OperationStack& m_OperationStack;
+    mutable QMutex m_QueueMutex;
+    QList<Job> m_Queue;
+    std::atomic<int> m_Generation;
+};
+
+#endif
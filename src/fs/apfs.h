@@ -29,13 +29,13 @@ public:
 
 public:
     CommandSupportType supportMove() const override {
-        return m_Move;
+        return probed(m_Move);
     }
     CommandSupportType supportCopy() const override {
-        return m_Copy;
+        return probed(m_Copy);
     }
     CommandSupportType supportBackup() const override {
-        return m_Backup;
+        return probed(m_Backup);
     }
 
     bool supportToolFound() const override {
@@ -5,6 +5,7 @@
 */
 
 #include "fs/bcachefs.h"
+#include "fs/filesystemfactory.h"
 
 #include "util/externalcommand.h"
 #include "util/capacity.h"
@@ -55,6 +56,8 @@ void bcachefs::init()
 
 bool bcachefs::supportToolFound() const
 {
+    FileSystemFactory::detectSupport(type());
+
     return
         m_GetUsed != cmdSupportNone &&
         m_GetLabel != cmdSupportNone &&
@@ -40,52 +40,52 @@ public:
     void setPosixPermissions(const QString& permissions) override { implSetPosixPermissions(permissions); };
 
     CommandSupportType supportGetUsed() const override {
-        return m_GetUsed;
+        return probed(m_GetUsed);
     }
     CommandSupportType supportGetLabel() const override {
-        return m_GetLabel;
+        return probed(m_GetLabel);
     }
     CommandSupportType supportCreate() const override {
-        return m_Create;
+        return probed(m_Create);
     }
     CommandSupportType supportCreateWithFeatures() const override {
-        return m_Create;
+        return probed(m_Create);
     }
     CommandSupportType supportGrow() const override {
-        return m_Grow;
+        return probed(m_Grow);
     }
     CommandSupportType supportGrowOnline() const override {
-        return m_Grow;
+        return probed(m_Grow);
     }
     CommandSupportType supportShrink() const override {
-        return m_Shrink;
+        return probed(m_Shrink);
     }
     CommandSupportType supportShrinkOnline() const override {
-        return m_Shrink;
+        return probed(m_Shrink);
     }
     CommandSupportType supportMove() const override {
-        return m_Move;
+        return probed(m_Move);
     }
     CommandSupportType supportCheck() const override {
-        return m_Check;
+        return probed(m_Check);
     }
     CommandSupportType supportCopy() const override {
-        return m_Copy;
+        return probed(m_Copy);
     }
     CommandSupportType supportBackup() const override {
-        return m_Backup;
+        return probed(m_Backup);
     }
     CommandSupportType supportSetLabel() const override {
-        return m_SetLabel;
+        return probed(m_SetLabel);
     }
     CommandSupportType supportSetLabelOnline() const override {
-        return m_SetLabel;
+        return probed(m_SetLabel);
     }
     CommandSupportType supportUpdateUUID() const override {
-        return m_UpdateUUID;
+        return probed(m_UpdateUUID);
     }
     CommandSupportType supportGetUUID() const override {
-        return m_GetUUID;
+        return probed(m_GetUUID);
     }
 
     qint64 minCapacity() const override;
@@ -9,6 +9,9 @@
 */
 
 #include "fs/btrfs.h"
+#include "fs/filesystemfactory.h"
+#include "fs/superblock.h"
+#include "fs/toolprobe.h"
 
 #include "util/externalcommand.h"
 #include "util/capacity.h"
@@ -59,9 +62,9 @@ void btrfs::init()
     m_GetUUID = cmdSupportCore;
 
     if (m_Create == cmdSupportFileSystem) {
-        ExternalCommand cmd(QStringLiteral("mkfs.btrfs"), QStringList() << QStringLiteral("-O") << QStringLiteral("list-all"));
-        if (cmd.run(-1) && cmd.exitCode() == 0) {
-            QStringList lines = cmd.output().split(QStringLiteral("\n"));
+        const ToolProbe::Result probe = ToolProbe::run(QStringLiteral("mkfs.btrfs"), { QStringLiteral("-O"), QStringLiteral("list-all") });
+        if (probe.found && probe.exitCode == 0) {
+            QStringList lines = QString::fromLocal8Bit(probe.output).split(QStringLiteral("\n"));
 
             // First line is introductory text, we don't need it
             lines.removeFirst();
@@ -77,6 +80,8 @@ void btrfs::init()
 
 bool btrfs::supportToolFound() const
 {
+    FileSystemFactory::detectSupport(type());
+
     return
         m_GetUsed != cmdSupportNone &&
         m_GetLabel != cmdSupportNone &&
@@ -114,6 +119,10 @@ int btrfs::maxLabelLength() const
 
 qint64 btrfs::readUsedCapacity(const QString& deviceNode) const
 {
+    const qint64 usedBytes = Superblock::btrfsUsedBytes(Superblock::read(deviceNode, Superblock::btrfsLayout));
+    if (usedBytes > -1)
+        return usedBytes;
+
     ExternalCommand cmd(QStringLiteral("btrfs"),
                         { QStringLiteral("filesystem"), QStringLiteral("show"), QStringLiteral("--raw"), deviceNode });
 
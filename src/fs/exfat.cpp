@@ -8,6 +8,7 @@
 */
 
 #include "fs/exfat.h"
+#include "fs/filesystemfactory.h"
 
 #include "util/externalcommand.h"
 #include "util/capacity.h"
@@ -63,6 +64,8 @@ void exfat::init()
 
 bool exfat::supportToolFound() const
 {
+    FileSystemFactory::detectSupport(type());
+
     return
 //          m_GetUsed != cmdSupportNone &&
         m_GetLabel != cmdSupportNone &&
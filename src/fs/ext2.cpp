@@ -8,6 +8,8 @@
 */
 
 #include "fs/ext2.h"
+#include "fs/filesystemfactory.h"
+#include "fs/superblock.h"
 
 #include "util/externalcommand.h"
 #include "util/capacity.h"
@@ -86,6 +88,8 @@ void ext2::init()
 
 bool ext2::supportToolFound() const
 {
+    FileSystemFactory::detectSupport(type());
+
     return
         m_GetUsed != cmdSupportNone &&
         m_GetLabel != cmdSupportNone &&
@@ -118,6 +122,10 @@ int ext2::maxLabelLength() const
 
 qint64 ext2::readUsedCapacity(const QString& deviceNode) const
 {
+    const qint64 usedBytes = Superblock::ext2UsedBytes(Superblock::read(deviceNode, Superblock::ext2Layout));
+    if (usedBytes > -1)
+        return usedBytes;
+
     ExternalCommand cmd(QStringLiteral("dumpe2fs"), { QStringLiteral("-h"), deviceNode });
 
     if (cmd.run()) {
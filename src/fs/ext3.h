@@ -40,7 +40,7 @@ public:
     qint64 maxCapacity() const override;
 
     CommandSupportType supportGrowOnline() const override {
-        return m_Grow;
+        return probed(m_Grow);
     }
 
     QString posixPermissions() const override { return implPosixPermissions();  };
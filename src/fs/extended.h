@@ -39,16 +39,16 @@ public:
     bool create(Report&, const QString&) override;
 
     CommandSupportType supportCreate() const override {
-        return m_Create;
+        return probed(m_Create);
     }
     CommandSupportType supportGrow() const override {
-        return m_Grow;
+        return probed(m_Grow);
     }
     CommandSupportType supportShrink() const override {
-        return m_Shrink;
+        return probed(m_Shrink);
     }
     CommandSupportType supportMove() const override {
-        return m_Move;
+        return probed(m_Move);
     }
 
     bool supportToolFound() const override {
@@ -7,6 +7,7 @@
 */
 
 #include "fs/f2fs.h"
+#include "fs/filesystemfactory.h"
 
 #include "util/externalcommand.h"
 #include "util/capacity.h"
@@ -62,6 +63,8 @@ void f2fs::init()
 
 bool f2fs::supportToolFound() const
 {
+    FileSystemFactory::detectSupport(type());
+
     return
 //         m_GetUsed != cmdSupportNone &&
         m_GetLabel != cmdSupportNone &&
@@ -10,6 +10,8 @@
 */
 
 #include "fs/fat12.h"
+#include "fs/filesystemfactory.h"
+#include "fs/superblock.h"
 
 #include "util/externalcommand.h"
 #include "util/capacity.h"
@@ -66,6 +68,8 @@ void fat12::init()
 
 bool fat12::supportToolFound() const
 {
+    FileSystemFactory::detectSupport(type());
+
     return
         m_GetUsed != cmdSupportNone &&
         m_GetLabel != cmdSupportNone &&
@@ -110,6 +114,10 @@ QValidator* fat12::labelValidator(QObject *parent) const
 
 qint64 fat12::readUsedCapacity(const QString& deviceNode) const
 {
+    const qint64 usedBytes = Superblock::fatUsedBytes(deviceNode);
+    if (usedBytes > -1)
+        return usedBytes;
+
     ExternalCommand cmd(QStringLiteral("fsck.fat"), { QStringLiteral("-n"), QStringLiteral("-v"), deviceNode });
 
     // Exit code 1 is returned when FAT dirty bit is set
@@ -9,6 +9,7 @@
 */
 
 #include "fs/fat16.h"
+#include "fs/filesystemfactory.h"
 
 #include "util/externalcommand.h"
 #include "util/capacity.h"
@@ -49,6 +50,8 @@ void fat16::init()
 
 bool fat16::supportToolFound() const
 {
+    FileSystemFactory::detectSupport(type());
+
     return
         m_GetUsed != cmdSupportNone &&
         m_GetLabel != cmdSupportNone &&
@@ -36,10 +36,10 @@ public:
     bool resize(Report& report, const QString& deviceNode, qint64 length) const override;
 
     CommandSupportType supportGrow() const override {
-        return m_Grow;
+        return probed(m_Grow);
     }
     CommandSupportType supportShrink() const override {
-        return m_Shrink;
+        return probed(m_Shrink);
     }
 
     qint64 minCapacity() const override;
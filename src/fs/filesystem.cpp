@@ -13,9 +13,12 @@
 */
 
 #include "fs/filesystem.h"
+#include "fs/filesystemfactory.h"
 #include "core/fstab.h"
+#include "core/mountindex.h"
 
 #include "fs/lvm2_pv.h"
+#include "fs/toolprobe.h"
 
 #include "backend/corebackend.h"
 #include "backend/corebackendmanager.h"
@@ -216,6 +219,9 @@ QString FileSystem::detectMountPoint(FileSystem* fs, const QString& partitionPat
     if (partitionPath.isEmpty()) // Happens when during initial scan LUKS is closed
         return QString();
 
+    if (const MountIndex* mountIndex = MountIndex::current())
+        return (mountIndex->mountPoints(partitionPath) + mountIndex->fstabMountPoints(partitionPath)).value(0);
+
     QStringList mountPoints;
     QFileInfo partitionPathFileInfo(partitionPath);
     QString partitionCanonicalPath = partitionPathFileInfo.canonicalFilePath();
@@ -237,6 +243,8 @@ bool FileSystem::detectMountStatus(FileSystem* fs, const QString& partitionPath)
 
     if (fs->type() == FileSystem::Type::Lvm2_PV) {
         mounted = !FS::lvm2_pv::getVGName(partitionPath).isEmpty();
+    } else if (const MountIndex* mountIndex = MountIndex::current()) {
+        mounted = mountIndex->isMounted(partitionPath);
     } else {
         mounted = isMounted(partitionPath);
     }
@@ -655,21 +663,27 @@ qint64 FileSystem::lastSector() const
 
 bool FileSystem::findExternal(const QString& cmdName, const QStringList& args, int expectedCode)
 {
-    QString cmdFullPath = findTrustedCommand(cmdName);
-
-    if (cmdFullPath.isEmpty())
-        return false;
-
-    ExternalCommand cmd(cmdFullPath, args);
-    if (!cmd.run())
+    const ToolProbe::Result probe = ToolProbe::run(cmdName, args);
+    if (!probe.found)
         return false;
 
-    return cmd.exitCode() == 0 || cmd.exitCode() == expectedCode;
+    return probe.exitCode == 0 || probe.exitCode == expectedCode;
 }
 
 void FileSystem::addAvailableFeature(const QString& name)
 {
-    d->m_AvailableFeatures.append(name);
+    if (!d->m_AvailableFeatures.contains(name))
+        d->m_AvailableFeatures.append(name);
+}
+
+/** Get a supported operation once init() ran for this type.
+    @param support one of the static members init() sets, it is read after init() ran
+    @return the value of support
+*/
+FileSystem::CommandSupportType FileSystem::probed(const CommandSupportType& support) const
+{
+    FileSystemFactory::detectSupport(type());
+    return support;
 }
 
 void FileSystem::addFeature(const QString& name, const QVariant& value)
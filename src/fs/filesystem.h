@@ -315,6 +315,7 @@ public:
 protected:
     static bool findExternal(const QString& cmdName, const QStringList& args = QStringList(), int exptectedCode = 1);
     void addAvailableFeature(const QString& name);
+    CommandSupportType probed(const CommandSupportType& support) const;
 
     std::unique_ptr<FileSystemPrivate> d;
 };
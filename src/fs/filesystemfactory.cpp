@@ -14,6 +14,7 @@
 
 #include "fs/filesystemfactory.h"
 #include "fs/filesystem.h"
+#include "fs/toolprobe.h"
 
 #include "fs/apfs.h"
 #include "fs/bcachefs.h"
@@ -55,12 +56,20 @@
 #include "backend/corebackendmanager.h"
 #include "backend/corebackend.h"
 
+#include <QMutexLocker>
+#include <QRecursiveMutex>
+#include <QSet>
+
 FileSystemFactory::FileSystems FileSystemFactory::m_FileSystems;
 
-/** Initializes the instance. */
-void FileSystemFactory::init()
+// Guards the detection of supported operations. Recursive as init() of a file
+// system may ask for the support of another type.
+static QRecursiveMutex supportMutex;
+static QSet<FileSystem::Type> detectedTypes;
+
+static FileSystemFactory::FileSystems createFileSystems()
 {
-    FileSystems fileSystems;
+    FileSystemFactory::FileSystems fileSystems;
     fileSystems.insert(FileSystem::Type::Apfs, new FS::apfs(-1, -1, -1, QString()));
     fileSystems.insert(FileSystem::Type::Bcachefs, new FS::bcachefs(-1, -1, -1, QString()));
     fileSystems.insert(FileSystem::Type::BitLocker, new FS::bitlocker(-1, -1, -1, QString()));
@@ -98,16 +107,90 @@ void FileSystemFactory::init()
     fileSystems.insert(FileSystem::Type::Xfs, new FS::xfs(-1, -1, -1, QString()));
     fileSystems.insert(FileSystem::Type::Zfs, new FS::zfs(-1, -1, -1, QString()));
 
-    for (const auto &fs : std::as_const(fileSystems))
-        fs->init();
+    return fileSystems;
+}
+
+/* File systems deriving from each other share the static members init() sets */
+static QList<FileSystem::Type> sharingSupport(FileSystem::Type t)
+{
+    static const QList<QList<FileSystem::Type>> families = {
+        { FileSystem::Type::Ext2, FileSystem::Type::Ext3, FileSystem::Type::Ext4 },
+        { FileSystem::Type::Fat12, FileSystem::Type::Fat16, FileSystem::Type::Fat32 },
+        { FileSystem::Type::Luks, FileSystem::Type::Luks2 },
+    };
+
+    for (const auto& family : families)
+        if (family.contains(t))
+            return family;
+
+    return { t };
+}
+
+/** Initializes the instance.
+
+    No tools are run here. What a FileSystem type supports is only found out the
+    first time it is asked for, see detectSupport().
+*/
+void FileSystemFactory::init()
+{
+    QMutexLocker locker(&supportMutex);
 
     qDeleteAll(m_FileSystems);
     m_FileSystems.clear();
-    m_FileSystems = fileSystems;
+    m_FileSystems = createFileSystems();
+    detectedTypes.clear();
 
     CoreBackendManager::self()->backend()->initFSSupport();
 }
 
+/** Finds out which operations a FileSystem type supports.
+
+    This runs init() of the type once, the support*() methods of FileSystem call it
+    before they answer.
+
+    @param t the FileSystem's type
+*/
+void FileSystemFactory::detectSupport(FileSystem::Type t)
+{
+    detectSupport(QList<FileSystem::Type> { t });
+}
+
+/**
+    @overload
+    @param types the FileSystem types, their tools are probed at the same time
+*/
+void FileSystemFactory::detectSupport(const QList<FileSystem::Type>& types)
+{
+    QMutexLocker locker(&supportMutex);
+
+    QList<FileSystem*> fileSystems;
+    for (const auto t : types) {
+        for (const auto type : sharingSupport(t)) {
+            if (detectedTypes.contains(type) || !m_FileSystems.contains(type))
+                continue;
+
+            // Mark the type first so an init() asking for its own support does not recurse
+            detectedTypes.insert(type);
+            fileSystems.append(m_FileSystems.value(type));
+        }
+    }
+
+    if (fileSystems.isEmpty())
+        return;
+
+    // Probes of tools that are not cached yet are collected in the first round and
+    // run at the same time, tools can depend on each other so repeat until all
+    // file systems found everything they looked for in the cache.
+    {
+        ToolProbe::Batch probes;
+        do {
+            for (const auto &fs : std::as_const(fileSystems))
+                fs->init();
+        } while (probes.runPending());
+    }
+    ToolProbe::save();
+}
+
 /** Creates a new FileSystem
     @param t the FileSystem's type
     @param firstsector the FileSystem's first sector relative to the Device
@@ -176,9 +259,10 @@ FileSystem* FileSystemFactory::create(const FileSystem& other)
     return create(other.type(), other.firstSector(), other.lastSector(), other.sectorSize(), other.sectorsUsed(), other.label(), other.features(), other.uuid());
 }
 
-/** @return the map of FileSystems */
+/** @return the map of FileSystems, what all of them support is detected first */
 const FileSystemFactory::FileSystems& FileSystemFactory::map()
 {
+    detectSupport(m_FileSystems.keys());
     return m_FileSystems;
 }
 
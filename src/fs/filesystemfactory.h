@@ -15,6 +15,7 @@
 
 #include "util/libpartitionmanagerexport.h"
 
+#include <QList>
 #include <QMap>
 #include <QtGlobal>
 
@@ -34,6 +35,8 @@ private:
 
 public:
     static void init();
+    static void detectSupport(FileSystem::Type t);
+    static void detectSupport(const QList<FileSystem::Type>& types);
     static FileSystem* create(FileSystem::Type t, qint64 firstsector, qint64 lastsector, qint64 sectorSize, qint64 sectorsused = -1, const QString& label = QString(), const QVariantMap& features = {}, const QString& uuid = QString());
     static FileSystem* create(const FileSystem& other);
     static FileSystem* cloneWithNewType(FileSystem::Type newType, const FileSystem& other);
@@ -5,6 +5,7 @@
 */
 
 #include "fs/freebsdswap.h"
+#include "fs/filesystemfactory.h"
 
 #include "util/externalcommand.h"
 
@@ -48,6 +49,8 @@ void freebsdswap::init()
 
 bool freebsdswap::supportToolFound() const
 {
+    FileSystemFactory::detectSupport(type());
+
     // UUID and labels are always unsupported by FreeBSD swap
     // everything other should be not cmdSupportNone
     return
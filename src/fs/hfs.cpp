@@ -9,6 +9,7 @@
 */
 
 #include "fs/hfs.h"
+#include "fs/filesystemfactory.h"
 
 #include "util/externalcommand.h"
 #include "util/capacity.h"
@@ -42,6 +43,8 @@ void hfs::init()
 
 bool hfs::supportToolFound() const
 {
+    FileSystemFactory::detectSupport(type());
+
     return
 //          m_GetUsed != cmdSupportNone &&
         m_GetLabel != cmdSupportNone &&
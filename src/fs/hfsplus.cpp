@@ -9,6 +9,7 @@
 */
 
 #include "fs/hfsplus.h"
+#include "fs/filesystemfactory.h"
 
 #include "util/externalcommand.h"
 #include "util/capacity.h"
@@ -43,6 +44,8 @@ void hfsplus::init()
 
 bool hfsplus::supportToolFound() const
 {
+    FileSystemFactory::detectSupport(type());
+
     return
 //          m_GetUsed != cmdSupportNone &&
         m_GetLabel != cmdSupportNone &&
@@ -8,6 +8,7 @@
 */
 
 #include "fs/jfs.h"
+#include "fs/filesystemfactory.h"
 
 #include "util/externalcommand.h"
 #include "util/report.h"
@@ -49,6 +50,8 @@ void jfs::init()
 
 bool jfs::supportToolFound() const
 {
+    FileSystemFactory::detectSupport(type());
+
     return
         m_GetUsed != cmdSupportNone &&
         m_GetLabel != cmdSupportNone &&
@@ -11,6 +11,7 @@
 */
 
 #include "fs/linuxswap.h"
+#include "fs/filesystemfactory.h"
 
 #include "util/externalcommand.h"
 
@@ -50,6 +51,8 @@ void linuxswap::init()
 
 bool linuxswap::supportToolFound() const
 {
+    FileSystemFactory::detectSupport(type());
+
     return
         m_GetUsed != cmdSupportNone &&
         m_GetLabel != cmdSupportNone &&
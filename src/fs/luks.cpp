@@ -15,6 +15,7 @@
 #include "fs/lvm2_pv.h"
 
 #include "fs/filesystemfactory.h"
+#include "fs/superblock.h"
 
 #include "util/externalcommand.h"
 #include "util/capacity.h"
@@ -25,6 +26,9 @@
 
 #include <QDebug>
 #include <QDialog>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QJsonDocument>
@@ -62,10 +66,10 @@ luks::luks(qint64 firstsector,
     : FileSystem(firstsector, lastsector, sectorsused, label, features, t)
     , m_innerFs(nullptr)
     , m_isCryptOpen(false)
-    , m_cryptsetupFound(m_Create != cmdSupportNone)
     , m_isMounted(false)
     , m_KeySize(-1)
     , m_PayloadOffset(-1)
+    , m_KeySlots(-1)
 {
 }
 
@@ -99,14 +103,20 @@ void luks::scan(const QString& deviceNode)
     getLuksInfo(deviceNode);
 }
 
+/** @return true if cryptsetup was found, the tools of this type are probed if they were not yet */
+bool luks::cryptsetupFound() const
+{
+    return probed(m_Create) != cmdSupportNone;
+}
+
 bool luks::supportToolFound() const
 {
-    return m_cryptsetupFound && ((m_isCryptOpen && m_innerFs) ? m_innerFs->supportToolFound() : true);
+    return cryptsetupFound() && ((m_isCryptOpen && m_innerFs) ? m_innerFs->supportToolFound() : true);
 }
 
 FileSystem::SupportTool luks::supportToolName() const
 {
-    if (m_isCryptOpen && m_innerFs && m_cryptsetupFound)
+    if (m_isCryptOpen && m_innerFs && cryptsetupFound())
         return m_innerFs->supportToolName();
     return SupportTool(QStringLiteral("cryptsetup"),
                        QUrl(QStringLiteral("https://code.google.com/p/cryptsetup/")));
@@ -219,7 +229,7 @@ bool luks::canCryptOpen(const QString&) const
 
 bool luks::canCryptClose(const QString&) const
 {
-    return m_isCryptOpen && !m_isMounted && m_cryptsetupFound;
+    return m_isCryptOpen && !m_isMounted && cryptsetupFound();
 }
 
 bool luks::isCryptOpen() const
@@ -535,6 +545,12 @@ QString luks::readOuterUUID(const QString &deviceNode) const
     if ( deviceNode.isEmpty() )
         return QString();
 
+    const Superblock::LuksInfo info = Superblock::luksInfo(deviceNode);
+    if (info.valid && !info.uuid.isEmpty()) {
+        const_cast< QString& >( m_outerUuid ) = info.uuid;
+        return info.uuid;
+    }
+
     ExternalCommand cmd(QStringLiteral("cryptsetup"),
                         { QStringLiteral("luksUUID"), deviceNode });
     if (cmd.run()) {
@@ -565,8 +581,40 @@ bool luks::updateUUID(Report& report, const QString& deviceNode) const
     return cmd.run(-1) && cmd.exitCode() == 0;
 }
 
+/** @return the sysfs directory of a block device, e.g. /sys/class/block/sda1/ */
+static QString sysfsBlockDirectory(const QString& deviceNode)
+{
+    const QString kernelName = QFileInfo(deviceNode).canonicalFilePath().section(QLatin1Char('/'), -1);
+    return kernelName.isEmpty() ? QString() : QStringLiteral("/sys/class/block/") + kernelName + QLatin1Char('/');
+}
+
+static QByteArray readSysfsAttribute(const QString& path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll().trimmed() : QByteArray();
+}
+
 void luks::getMapperName(const QString& deviceNode)
 {
+    m_MapperName = QString();
+
+    // An open LUKS volume is held by a dm-crypt device whose dm uuid starts with CRYPT-
+    const QString sysfsDir = sysfsBlockDirectory(deviceNode);
+    if (!sysfsDir.isEmpty() && QFileInfo::exists(sysfsDir)) {
+        const QStringList holders = QDir(sysfsDir + QStringLiteral("holders")).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+        for (const QString& holder : holders) {
+            const QString dmDir = sysfsDir + QStringLiteral("holders/") + holder + QStringLiteral("/dm/");
+            if (readSysfsAttribute(dmDir + QStringLiteral("uuid")).startsWith("CRYPT-")) {
+                const QString name = QString::fromLocal8Bit(readSysfsAttribute(dmDir + QStringLiteral("name")));
+                if (!name.isEmpty()) {
+                    m_MapperName = QStringLiteral("/dev/mapper/") + name;
+                    return;
+                }
+            }
+        }
+        return;
+    }
+
     ExternalCommand cmd(QStringLiteral("lsblk"),
                         { QStringLiteral("--list"),
                           QStringLiteral("--noheadings"),
@@ -575,7 +623,6 @@ void luks::getMapperName(const QString& deviceNode)
                           QStringLiteral("--output"),
                           QStringLiteral("type,name"),
                           deviceNode });
-    m_MapperName = QString();
 
     if (cmd.run(-1) && cmd.exitCode() == 0) {
         const QJsonDocument jsonDocument = QJsonDocument::fromJson(cmd.rawOutput());
@@ -593,6 +640,24 @@ void luks::getMapperName(const QString& deviceNode)
 
 void luks::getLuksInfo(const QString& deviceNode)
 {
+    const Superblock::LuksInfo info = Superblock::luksInfo(deviceNode);
+    if (info.valid) {
+        auto orUnknown = [] (const QString& value) {
+            return value.isEmpty() ? QStringLiteral("---") : value;
+        };
+        m_CipherName = orUnknown(info.cipherName);
+        m_CipherMode = orUnknown(info.cipherMode);
+        m_HashName = orUnknown(info.hashName);
+        m_KeySize = info.keySize;
+        m_PayloadOffset = info.payloadOffset;
+        m_KeySlots = info.activeKeySlots;
+        if (!info.uuid.isEmpty())
+            m_outerUuid = info.uuid;
+        return;
+    }
+
+    m_KeySlots = -1;
+
     ExternalCommand cmd(QStringLiteral("cryptsetup"), { QStringLiteral("luksDump"), deviceNode });
     if (cmd.run(-1) && cmd.exitCode() == 0) {
         QRegularExpression re(QStringLiteral("Cipher name:\\s+(\\w+)"));
@@ -683,6 +748,17 @@ void luks::initLUKS()
 
 void luks::setPayloadSize()
 {
+    // size of the dm-crypt device in 512 byte sectors, like the length in its dm table
+    const QString sysfsDir = sysfsBlockDirectory(mapperName());
+    if (!sysfsDir.isEmpty()) {
+        bool ok;
+        const qint64 sectors = readSysfsAttribute(sysfsDir + QStringLiteral("size")).toLongLong(&ok);
+        if (ok) {
+            m_PayloadSize = sectors * sectorSize();
+            return;
+        }
+    }
+
     ExternalCommand dmsetupCmd(QStringLiteral("dmsetup"), { QStringLiteral("table"), mapperName() });
     dmsetupCmd.run();
     QRegularExpression re(QStringLiteral("\\d+ (\\d+)"));
@@ -47,79 +47,79 @@ public:
     qint64 readUsedCapacity(const QString& deviceNode) const override;
 
     CommandSupportType supportGetUsed() const override {
-        return m_GetUsed;
+        return probed(m_GetUsed);
     }
     CommandSupportType supportGetLabel() const override {
-        return m_GetLabel;
+        return probed(m_GetLabel);
     }
     CommandSupportType supportCreate() const override {
-        return m_Create;
+        return probed(m_Create);
     }
     CommandSupportType supportGrow() const override {
         if (!m_isCryptOpen)
             return cmdSupportNone;
-        if (m_Grow && m_innerFs)
+        if (probed(m_Grow) && m_innerFs)
             return m_innerFs->supportGrow();
         return cmdSupportNone;
     }
     CommandSupportType supportGrowOnline() const override {
         if (!m_isCryptOpen)
             return cmdSupportNone;
-        if (m_Grow && m_innerFs)
+        if (probed(m_Grow) && m_innerFs)
             return m_innerFs->supportGrowOnline();
         return cmdSupportNone;
     }
     CommandSupportType supportShrink() const override {
         if (!m_isCryptOpen)
             return cmdSupportNone;
-        if (m_Shrink && m_innerFs)
+        if (probed(m_Shrink) && m_innerFs)
             return m_innerFs->supportShrink();
         return cmdSupportNone;
     }
     CommandSupportType supportShrinkOnline() const override {
         if (!m_isCryptOpen)
             return cmdSupportNone;
-        if (m_Shrink && m_innerFs)
+        if (probed(m_Shrink) && m_innerFs)
             return m_innerFs->supportShrinkOnline();
         return cmdSupportNone;
     }
     CommandSupportType supportMove() const override {
         if (m_isCryptOpen)
             return cmdSupportNone;
-        return m_Move;
+        return probed(m_Move);
     }
     CommandSupportType supportCheck() const override {
         if (!m_isCryptOpen)
             return cmdSupportNone;
-        if (m_Check && m_innerFs)
+        if (probed(m_Check) && m_innerFs)
             return m_innerFs->supportCheck();
         return cmdSupportNone;
     }
     CommandSupportType supportCheckOnline() const override {
         if (!m_isCryptOpen)
             return cmdSupportNone;
-        if (m_Check && m_innerFs)
+        if (probed(m_Check) && m_innerFs)
             return m_innerFs->supportCheckOnline();
         return cmdSupportNone;
     }
     CommandSupportType supportCopy() const override {
         if (m_isCryptOpen)
             return cmdSupportNone;
-        return m_Copy;
+        return probed(m_Copy);
     }
     CommandSupportType supportBackup() const override {
-        return m_Backup;
+        return probed(m_Backup);
     }
     CommandSupportType supportSetLabel() const override {
-        if (m_Check && m_innerFs)
+        if (probed(m_Check) && m_innerFs)
             return m_innerFs->supportSetLabel();
         return cmdSupportNone;
     }
     CommandSupportType supportUpdateUUID() const override {
-        return m_UpdateUUID;
+        return probed(m_UpdateUUID);
     }
     CommandSupportType supportGetUUID() const override {
-        return m_GetUUID;
+        return probed(m_GetUUID);
     }
 
     bool check(Report& report, const QString& deviceNode) const override;
@@ -180,6 +180,7 @@ public:
     QString hashName() const { return m_HashName; }
     qint64 keySize() const { return m_KeySize; }
     qint64 payloadOffset() const { return m_PayloadOffset; }
+    int keySlots() const { return m_KeySlots; }
 
     static bool canEncryptType(FileSystem::Type type);
     void initLUKS();
@@ -189,6 +190,7 @@ public:
 protected:
     virtual QString readOuterUUID(const QString& deviceNode) const;
     void setPayloadSize();
+    bool cryptsetupFound() const;
 
 public:
     static CommandSupportType m_GetUsed;
@@ -208,7 +210,6 @@ protected:
     mutable FileSystem* m_innerFs;
 
     mutable bool m_isCryptOpen;
-    mutable bool m_cryptsetupFound;
     QString m_passphrase;
     bool m_isMounted;
 
@@ -218,6 +219,7 @@ protected:
     QString m_HashName;
     qint64 m_KeySize;
     qint64 m_PayloadOffset;
+    int m_KeySlots;
     qint64 m_PayloadSize;
     QString m_outerUuid;
 
@@ -11,7 +11,9 @@
 */
 
 #include "fs/lvm2_pv.h"
+#include "fs/filesystemfactory.h"
 #include "core/device.h"
+#include "core/lvmreport.h"
 
 #include "util/externalcommand.h"
 #include "util/capacity.h"
@@ -74,6 +76,8 @@ void lvm2_pv::scan(const QString& deviceNode)
 
 bool lvm2_pv::supportToolFound() const
 {
+    FileSystemFactory::detectSupport(type());
+
     return
         m_GetUsed != cmdSupportNone &&
         m_Create != cmdSupportNone &&
@@ -224,6 +228,10 @@ void lvm2_pv::getPESize(const QString& deviceNode)
  */
 QString  lvm2_pv::getpvField(const QString& fieldName, const QString& deviceNode)
 {
+    // During a scan all PVs are described by a single lvm fullreport
+    if (const LvmReport* report = LvmReport::current(); report && !deviceNode.isEmpty() && report->isValid() && report->containsPV(deviceNode))
+        return report->pvField(fieldName, deviceNode);
+
     QStringList args = { QStringLiteral("pvs"),
                     QStringLiteral("--foreign"),
                     QStringLiteral("--readonly"),
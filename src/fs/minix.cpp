@@ -7,6 +7,7 @@
 */
  
 #include "fs/minix.h"
+#include "fs/filesystemfactory.h"
 
 #include "util/capacity.h"
 #include "util/externalcommand.h"
@@ -41,6 +42,8 @@ void minix::init()
 
 bool minix::supportToolFound() const
 {
+    FileSystemFactory::detectSupport(type());
+
     return m_GetLabel != cmdSupportNone &&
            m_Create != cmdSupportNone &&
            m_Check != cmdSupportNone &&
@@ -36,35 +36,35 @@ public:
     void setPosixPermissions(const QString& permissions) override { implSetPosixPermissions(permissions); };
 
     CommandSupportType supportGetLabel() const override {
-        return m_GetLabel;
+        return probed(m_GetLabel);
     }
     
     CommandSupportType supportGetUsed() const override {
-        return m_GetUsed;
+        return probed(m_GetUsed);
     }
 
     CommandSupportType supportShrink() const override {
-        return m_Shrink;
+        return probed(m_Shrink);
     }
 
     CommandSupportType supportMove() const override {
-        return m_Move;
+        return probed(m_Move);
     }
     
     CommandSupportType supportCheck() const override {
-        return m_Check;
+        return probed(m_Check);
     }
     
     CommandSupportType supportCreate() const override {
-        return m_Create;
+        return probed(m_Create);
     }
     
     CommandSupportType supportCopy() const override {
-        return m_Copy;
+        return probed(m_Copy);
     }
     
     CommandSupportType supportBackup() const override {
-        return m_Backup;
+        return probed(m_Backup);
     }
 
     qint64 maxCapacity() const override;
@@ -8,6 +8,7 @@
 */
 
 #include "fs/nilfs2.h"
+#include "fs/filesystemfactory.h"
 
 #include "util/externalcommand.h"
 #include "util/capacity.h"
@@ -65,6 +66,8 @@ void nilfs2::init()
 
 bool nilfs2::supportToolFound() const
 {
+    FileSystemFactory::detectSupport(type());
+
     return
         m_GetUsed != cmdSupportNone &&
         m_GetLabel != cmdSupportNone &&
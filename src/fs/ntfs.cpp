@@ -9,6 +9,7 @@
 */
 
 #include "fs/ntfs.h"
+#include "fs/filesystemfactory.h"
 
 #include "util/externalcommand.h"
 #include "util/capacity.h"
@@ -61,6 +62,8 @@ void ntfs::init()
 
 bool ntfs::supportToolFound() const
 {
+    FileSystemFactory::detectSupport(type());
+
     return
         m_GetUsed != cmdSupportNone &&
         m_GetLabel != cmdSupportNone &&
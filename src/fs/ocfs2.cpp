@@ -10,6 +10,7 @@
 */
 
 #include "fs/ocfs2.h"
+#include "fs/filesystemfactory.h"
 
 #include "util/externalcommand.h"
 #include "util/capacity.h"
@@ -60,6 +61,8 @@ void ocfs2::init()
 
 bool ocfs2::supportToolFound() const
 {
+    FileSystemFactory::detectSupport(type());
+
     return
 //          m_GetUsed != cmdSupportNone &&
         m_GetLabel != cmdSupportNone &&
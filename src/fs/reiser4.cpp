@@ -9,6 +9,7 @@
 */
 
 #include "fs/reiser4.h"
+#include "fs/filesystemfactory.h"
 
 #include "util/capacity.h"
 #include "util/externalcommand.h"
@@ -43,6 +44,8 @@ void reiser4::init()
 
 bool reiser4::supportToolFound() const
 {
+    FileSystemFactory::detectSupport(type());
+
     return
         m_GetUsed != cmdSupportNone &&
         m_GetLabel != cmdSupportNone &&
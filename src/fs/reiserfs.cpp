@@ -9,6 +9,7 @@
 */
 
 #include "fs/reiserfs.h"
+#include "fs/filesystemfactory.h"
 
 #include "util/externalcommand.h"
 #include "util/capacity.h"
@@ -55,6 +56,8 @@ void reiserfs::init()
 
 bool reiserfs::supportToolFound() const
 {
+    FileSystemFactory::detectSupport(type());
+
     return
         m_GetUsed != cmdSupportNone &&
         m_GetLabel != cmdSupportNone &&
@@ -0,0 +1,348 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "fs/superblock.h"
+
+#include "util/externalcommand.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+#include <QtEndian>
+
+namespace Superblock
+{
+
+template <typename T>
+static T le(const QByteArray& data, qint64 offset)
+{
+    return qFromLittleEndian<T>(data.constData() + offset);
+}
+
+template <typename T>
+static T be(const QByteArray& data, qint64 offset)
+{
+    return qFromBigEndian<T>(data.constData() + offset);
+}
+
+/** Read an on-disk structure through the helper.
+    @param deviceNode the device node the file system is on
+    @param layout position of the structure
+    @return the data or an empty QByteArray on error
+*/
+QByteArray read(const QString& deviceNode, const Layout& layout)
+{
+    ExternalCommand cmd;
+    const QByteArray data = cmd.readData(deviceNode, layout.offset, layout.length);
+    return data.size() == layout.length ? data : QByteArray();
+}
+
+/* struct ext2_super_block, all fields little endian */
+qint64 ext2UsedBytes(const QByteArray& superblock)
+{
+    constexpr qint64 blocksCountLo = 0x04;
+    constexpr qint64 freeBlocksCountLo = 0x0C;
+    constexpr qint64 logBlockSize = 0x18;
+    constexpr qint64 magic = 0x38;
+    constexpr qint64 featureIncompat = 0x60;
+    constexpr qint64 blocksCountHi = 0x150;
+    constexpr qint64 freeBlocksCountHi = 0x158;
+    constexpr quint32 incompat64Bit = 0x80;
+
+    if (superblock.size() < ext2Layout.length || le<quint16>(superblock, magic) != 0xEF53)
+        return -1;
+
+    const quint32 log = le<quint32>(superblock, logBlockSize);
+    if (log > 6) // block size is at most 64 KiB
+        return -1;
+    const qint64 blockSize = 1024LL << log;
+
+    quint64 blocks = le<quint32>(superblock, blocksCountLo);
+    quint64 freeBlocks = le<quint32>(superblock, freeBlocksCountLo);
+    if (le<quint32>(superblock, featureIncompat) & incompat64Bit) {
+        blocks |= static_cast<quint64>(le<quint32>(superblock, blocksCountHi)) << 32;
+        freeBlocks |= static_cast<quint64>(le<quint32>(superblock, freeBlocksCountHi)) << 32;
+    }
+
+    if (freeBlocks > blocks)
+        return -1;
+
+    return static_cast<qint64>(blocks - freeBlocks) * blockSize;
+}
+
+/* struct xfs_dsb, all fields big endian */
+qint64 xfsUsedBytes(const QByteArray& superblock)
+{
+    constexpr qint64 magicNum = 0;
+    constexpr qint64 blockSize = 4;
+    constexpr qint64 dBlocks = 8;
+    constexpr qint64 fdBlocks = 144;
+
+    if (superblock.size() < xfsLayout.length || be<quint32>(superblock, magicNum) != 0x58465342) // "XFSB"
+        return -1;
+
+    const quint64 blocks = be<quint64>(superblock, dBlocks);
+    const quint64 freeBlocks = be<quint64>(superblock, fdBlocks);
+    if (freeBlocks > blocks)
+        return -1;
+
+    return static_cast<qint64>(blocks - freeBlocks) * be<quint32>(superblock, blockSize);
+}
+
+/* struct btrfs_super_block, all fields little endian.
+   Like "btrfs filesystem show" this returns the bytes allocated on this device. */
+qint64 btrfsUsedBytes(const QByteArray& superblock)
+{
+    constexpr qint64 magic = 0x40;
+    constexpr qint64 devItemBytesUsed = 0xC9 + 16; // struct btrfs_dev_item: devid, total_bytes, bytes_used
+
+    if (superblock.size() < btrfsLayout.length || superblock.mid(magic, 8) != QByteArrayLiteral("_BHRfS_M"))
+        return -1;
+
+    return static_cast<qint64>(le<quint64>(superblock, devItemBytesUsed));
+}
+
+/* BIOS parameter block, see the Microsoft FAT specification */
+FatGeometry fatGeometry(const QByteArray& bootSector)
+{
+    FatGeometry g;
+    if (bootSector.size() < fatLayout.length || static_cast<quint8>(bootSector[510]) != 0x55 || static_cast<quint8>(bootSector[511]) != 0xAA)
+        return g;
+
+    g.bytesPerSector = le<quint16>(bootSector, 0x0B);
+    g.sectorsPerCluster = static_cast<quint8>(bootSector[0x0D]);
+    g.reservedSectors = le<quint16>(bootSector, 0x0E);
+    const qint64 numFats = static_cast<quint8>(bootSector[0x10]);
+    const qint64 rootEntries = le<quint16>(bootSector, 0x11);
+    qint64 totalSectors = le<quint16>(bootSector, 0x13);
+    if (totalSectors == 0)
+        totalSectors = le<quint32>(bootSector, 0x20);
+    g.sectorsPerFat = le<quint16>(bootSector, 0x16);
+    if (g.sectorsPerFat == 0)
+        g.sectorsPerFat = le<quint32>(bootSector, 0x24);
+
+    if (g.bytesPerSector < 512 || g.sectorsPerCluster == 0 || numFats == 0 || g.sectorsPerFat == 0)
+        return g;
+
+    const qint64 rootDirSectors = (rootEntries * 32 + g.bytesPerSector - 1) / g.bytesPerSector;
+    const qint64 dataSectors = totalSectors - (g.reservedSectors + numFats * g.sectorsPerFat + rootDirSectors);
+    if (dataSectors <= 0)
+        return g;
+
+    g.clusterCount = dataSectors / g.sectorsPerCluster;
+    if (g.clusterCount < 4085)
+        g.fatBits = 12;
+    else if (g.clusterCount < 65525)
+        g.fatBits = 16;
+    else {
+        g.fatBits = 32;
+        g.fsInfoSector = le<quint16>(bootSector, 0x30);
+    }
+
+    g.valid = true;
+    return g;
+}
+
+/* FAT32 keeps the number of free clusters in the FSInfo sector */
+qint64 fatUsedBytesFromFsInfo(const FatGeometry& geometry, const QByteArray& fsInfo)
+{
+    if (!geometry.valid || geometry.fatBits != 32 || fsInfo.size() < 512)
+        return -1;
+
+    if (le<quint32>(fsInfo, 0) != 0x41615252 || le<quint32>(fsInfo, 484) != 0x61417272 || le<quint32>(fsInfo, 508) != 0xAA550000)
+        return -1;
+
+    const quint32 freeClusters = le<quint32>(fsInfo, 488);
+    if (freeClusters == 0xFFFFFFFF || freeClusters > geometry.clusterCount) // unknown
+        return -1;
+
+    return (geometry.clusterCount - freeClusters) * geometry.clusterSize();
+}
+
+/* FAT12 and FAT16 have no free cluster count, so count the allocated entries of the first FAT */
+qint64 fatUsedBytesFromTable(const FatGeometry& geometry, const QByteArray& fat)
+{
+    if (!geometry.valid || (geometry.fatBits != 12 && geometry.fatBits != 16))
+        return -1;
+
+    const qint64 lastCluster = geometry.clusterCount + 1; // first data cluster is 2
+    const qint64 needed = geometry.fatBits == 12 ? lastCluster + lastCluster / 2 + 2 : (lastCluster + 1) * 2;
+    if (fat.size() < needed)
+        return -1;
+
+    qint64 usedClusters = 0;
+    for (qint64 cluster = 2; cluster <= lastCluster; ++cluster) {
+        quint16 entry;
+        if (geometry.fatBits == 12) {
+            entry = le<quint16>(fat, cluster + cluster / 2);
+            entry = (cluster & 1) ? entry >> 4 : entry & 0x0FFF;
+        }
+        else
+            entry = le<quint16>(fat, cluster * 2);
+
+        if (entry != 0)
+            ++usedClusters;
+    }
+
+    return usedClusters * geometry.clusterSize();
+}
+
+/** @return the used bytes of the FAT file system on deviceNode or -1 on error */
+qint64 fatUsedBytes(const QString& deviceNode)
+{
+    const FatGeometry geometry = fatGeometry(read(deviceNode, fatLayout));
+    if (!geometry.valid)
+        return -1;
+
+    if (geometry.fatBits == 32)
+        return fatUsedBytesFromFsInfo(geometry, read(deviceNode, { geometry.fsInfoSector * geometry.bytesPerSector, 512 }));
+
+    const Layout fatTable { geometry.reservedSectors * geometry.bytesPerSector, geometry.sectorsPerFat * geometry.bytesPerSector };
+    if (fatTable.length > 1024 * 1024) // more than the helper reads at once, FAT16 tables are at most 128 KiB
+        return -1;
+    return fatUsedBytesFromTable(geometry, read(deviceNode, fatTable));
+}
+
+static bool isLuksMagic(const QByteArray& header)
+{
+    return header.size() >= 8 && header.startsWith(QByteArrayLiteral("LUKS\xba\xbe"));
+}
+
+/** @return the size of the LUKS header including the LUKS2 JSON area or -1 if header is not LUKS */
+qint64 luksHeaderSize(const QByteArray& header)
+{
+    constexpr qint64 luks1HeaderSize = 592;
+
+    if (!isLuksMagic(header) || header.size() < 16)
+        return -1;
+
+    switch (be<quint16>(header, 6)) {
+    case 1:
+        return luks1HeaderSize;
+    case 2:
+        return static_cast<qint64>(be<quint64>(header, 8)); // hdr_size
+    default:
+        return -1;
+    }
+}
+
+static QString headerString(const QByteArray& header, qint64 offset, qint64 length)
+{
+    const QByteArray field = header.mid(offset, length);
+    const qsizetype end = field.indexOf('\0');
+    return QString::fromLatin1(end < 0 ? field : field.left(end)).trimmed();
+}
+
+/* struct luks_phdr, all fields big endian */
+static LuksInfo luks1Info(const QByteArray& header)
+{
+    constexpr qint64 cipherName = 8;
+    constexpr qint64 cipherMode = 40;
+    constexpr qint64 hashSpec = 72;
+    constexpr qint64 payloadOffset = 104;
+    constexpr qint64 keyBytes = 108;
+    constexpr qint64 uuid = 168;
+    constexpr qint64 keyBlock = 208;
+    constexpr qint64 keyBlockSize = 48;
+    constexpr int numKeys = 8;
+    constexpr quint32 keyEnabled = 0x00AC71F3;
+
+    LuksInfo info;
+    if (header.size() < keyBlock + numKeys * keyBlockSize)
+        return info;
+
+    info.version = 1;
+    info.cipherName = headerString(header, cipherName, 32);
+    info.cipherMode = headerString(header, cipherMode, 32);
+    info.hashName = headerString(header, hashSpec, 32);
+    info.payloadOffset = static_cast<qint64>(be<quint32>(header, payloadOffset)) * 512;
+    info.keySize = static_cast<qint64>(be<quint32>(header, keyBytes)) * 8;
+    info.uuid = headerString(header, uuid, 40);
+
+    info.activeKeySlots = 0;
+    for (int i = 0; i < numKeys; ++i)
+        if (be<quint32>(header, keyBlock + i * keyBlockSize) == keyEnabled)
+            ++info.activeKeySlots;
+
+    info.valid = true;
+    return info;
+}
+
+/* struct luks2_hdr_disk followed by the JSON metadata at offset 4096 */
+static LuksInfo luks2Info(const QByteArray& header)
+{
+    constexpr qint64 uuid = 168;
+    constexpr qint64 jsonOffset = 4096;
+
+    LuksInfo info;
+    const qint64 headerSize = luksHeaderSize(header);
+    if (headerSize <= jsonOffset || header.size() < headerSize)
+        return info;
+
+    QByteArray json = header.mid(jsonOffset, headerSize - jsonOffset);
+    const qsizetype end = json.indexOf('\0');
+    if (end >= 0)
+        json.truncate(end);
+
+    const QJsonObject metadata = QJsonDocument::fromJson(json).object();
+    if (metadata.isEmpty())
+        return info;
+
+    info.version = 2;
+    info.uuid = headerString(header, uuid, 40);
+
+    // Use the first segment and the digest and keyslots belonging to it, like cryptsetup luksDump shows them
+    const QJsonObject segment = metadata[QStringLiteral("segments")].toObject()[QStringLiteral("0")].toObject();
+    const QString encryption = segment[QStringLiteral("encryption")].toString();
+    const qsizetype dash = encryption.indexOf(QLatin1Char('-'));
+    info.cipherName = dash < 0 ? encryption : encryption.left(dash);
+    info.cipherMode = dash < 0 ? QString() : encryption.mid(dash + 1);
+    info.payloadOffset = segment[QStringLiteral("offset")].toString().toLongLong();
+
+    const QJsonObject digests = metadata[QStringLiteral("digests")].toObject();
+    if (!digests.isEmpty())
+        info.hashName = digests.begin().value().toObject()[QStringLiteral("hash")].toString();
+
+    const QJsonObject keyslots = metadata[QStringLiteral("keyslots")].toObject();
+    info.activeKeySlots = keyslots.size();
+    if (!keyslots.isEmpty())
+        info.keySize = keyslots.begin().value().toObject()[QStringLiteral("key_size")].toInteger() * 8;
+
+    info.valid = true;
+    return info;
+}
+
+/** Parse a LUKS header.
+    @param header the start of the volume, for LUKS2 including the whole JSON area
+*/
+LuksInfo luksInfo(const QByteArray& header)
+{
+    if (!isLuksMagic(header))
+        return {};
+
+    return be<quint16>(header, 6) == 1 ? luks1Info(header) : luks2Info(header);
+}
+
+/** @return the metadata of the LUKS volume on deviceNode, invalid on error */
+LuksInfo luksInfo(const QString& deviceNode)
+{
+    QByteArray header = read(deviceNode, luksLayout);
+
+    // LUKS2 headers can be bigger than the default, read the rest of the JSON area
+    const qint64 headerSize = luksHeaderSize(header);
+    if (headerSize > luksLayout.length && headerSize <= 4 * 1024 * 1024) {
+        for (qint64 offset = luksLayout.length; offset < headerSize; offset += 1024 * 1024) {
+            const QByteArray chunk = read(deviceNode, { offset, qMin<qint64>(1024 * 1024, headerSize - offset) });
+            if (chunk.isEmpty())
+                return {};
+            header += chunk;
+        }
+    }
+
+    return luksInfo(header);
+}
+
+}
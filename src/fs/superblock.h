@@ -0,0 +1,85 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_SUPERBLOCK_H
+#define KPMCORE_SUPERBLOCK_H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+
+/** Parsers for on-disk file system superblocks and LUKS headers.
+
+    Reading the usage of a file system from its superblock needs a single small read
+    through the helper instead of running the file system's tools and parsing their
+    output. The parsers only look at fixed fields and return -1 if the data does not
+    look like the expected structure, so callers can fall back to the tools.
+*/
+namespace Superblock
+{
+/** Position of an on-disk structure relative to the start of the file system */
+struct Layout
+{
+    qint64 offset;
+    qint64 length;
+};
+
+constexpr Layout ext2Layout { 1024, 1024 };
+constexpr Layout xfsLayout { 0, 512 };
+constexpr Layout btrfsLayout { 64 * 1024, 4096 };
+constexpr Layout fatLayout { 0, 512 };
+constexpr Layout luksLayout { 0, 16 * 1024 }; // LUKS1 header and the default LUKS2 header with its JSON area
+
+/** Geometry of a FAT file system as described by its boot sector */
+struct FatGeometry
+{
+    bool valid = false;
+    int fatBits = 0;                /**< 12, 16 or 32 */
+    qint64 bytesPerSector = 0;
+    qint64 sectorsPerCluster = 0;
+    qint64 reservedSectors = 0;
+    qint64 sectorsPerFat = 0;
+    qint64 clusterCount = 0;        /**< number of data clusters */
+    qint64 fsInfoSector = 0;        /**< FAT32 only */
+
+    qint64 clusterSize() const {
+        return bytesPerSector * sectorsPerCluster;
+    }
+};
+
+/** Metadata of a LUKS1 or LUKS2 volume as stored in its header */
+struct LuksInfo
+{
+    bool valid = false;
+    int version = 0;
+    QString uuid;
+    QString cipherName;             /**< e.g. aes */
+    QString cipherMode;             /**< e.g. xts-plain64 */
+    QString hashName;               /**< hash of the volume key digest, e.g. sha256 */
+    qint64 keySize = -1;            /**< volume key size in bits */
+    qint64 payloadOffset = -1;      /**< start of the encrypted data in bytes */
+    int activeKeySlots = -1;
+};
+
+LIBKPMCORE_EXPORT QByteArray read(const QString& deviceNode, const Layout& layout);
+
+LIBKPMCORE_EXPORT qint64 ext2UsedBytes(const QByteArray& superblock);
+LIBKPMCORE_EXPORT qint64 xfsUsedBytes(const QByteArray& superblock);
+LIBKPMCORE_EXPORT qint64 btrfsUsedBytes(const QByteArray& superblock);
+
+LIBKPMCORE_EXPORT FatGeometry fatGeometry(const QByteArray& bootSector);
+LIBKPMCORE_EXPORT qint64 fatUsedBytesFromFsInfo(const FatGeometry& geometry, const QByteArray& fsInfo);
+LIBKPMCORE_EXPORT qint64 fatUsedBytesFromTable(const FatGeometry& geometry, const QByteArray& fat);
+LIBKPMCORE_EXPORT qint64 fatUsedBytes(const QString& deviceNode);
+
+LIBKPMCORE_EXPORT qint64 luksHeaderSize(const QByteArray& header);
+LIBKPMCORE_EXPORT LuksInfo luksInfo(const QByteArray& header);
+LIBKPMCORE_EXPORT LuksInfo luksInfo(const QString& deviceNode);
+}
+
+#endif
@@ -0,0 +1,261 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "fs/toolprobe.h"
+
+#include "util/externalcommand.h"
+#include "util/externalcommand_trustedprefixes.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <utility>
+
+#include <sys/stat.h>
+
+namespace {
+/** Identity of the tool binary when it was probed */
+struct FileStamp
+{
+    quint64 device = 0;
+    quint64 inode = 0;
+    qint64 size = -1;
+    qint64 mtime = 0;       // nanoseconds
+
+    bool operator==(const FileStamp& other) const {
+        return device == other.device && inode == other.inode && size == other.size && mtime == other.mtime;
+    }
+};
+
+struct Entry
+{
+    QString path;
+    QStringList args;
+    FileStamp stamp;
+    ToolProbe::Result result;
+};
+
+QMutex cacheMutex;
+QHash<QString, Entry> cache;
+bool cacheLoaded = false;
+bool cacheDirty = false;
+thread_local ToolProbe::Batch* currentBatch = nullptr;
+
+constexpr int cacheVersion = 1;
+constexpr int probeTimeout = 30000; // ms, a tool that hangs must not stall the scan
+}
+
+static QString cacheFileName()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/kpmcore/toolprobes.json");
+}
+
+static QString cacheKey(const QString& path, const QStringList& args)
+{
+    return (QStringList { path } + args).join(QChar(0));
+}
+
+static FileStamp fileStamp(const QString& path)
+{
+    FileStamp stamp;
+    struct stat st;
+    if (stat(QFile::encodeName(path).constData(), &st) == 0) {
+        stamp.device = st.st_dev;
+        stamp.inode = st.st_ino;
+        stamp.size = st.st_size;
+        stamp.mtime = static_cast<qint64>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    }
+    return stamp;
+}
+
+/* Called with cacheMutex locked */
+static void loadCache()
+{
+    if (cacheLoaded)
+        return;
+    cacheLoaded = true;
+
+    QFile file(cacheFileName());
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root[QLatin1String("version")].toInt() != cacheVersion)
+        return;
+
+    const QJsonArray probes = root[QLatin1String("probes")].toArray();
+    for (const QJsonValue& value : probes) {
+        const QJsonObject probe = value.toObject();
+
+        Entry entry;
+        entry.path = probe[QLatin1String("path")].toString();
+        for (const QJsonValue& arg : probe[QLatin1String("args")].toArray())
+            entry.args.append(arg.toString());
+        entry.stamp.device = probe[QLatin1String("device")].toString().toULongLong();
+        entry.stamp.inode = probe[QLatin1String("inode")].toString().toULongLong();
+        entry.stamp.size = probe[QLatin1String("size")].toString().toLongLong();
+        entry.stamp.mtime = probe[QLatin1String("mtime")].toString().toLongLong();
+        entry.result.found = true;
+        entry.result.exitCode = probe[QLatin1String("exitCode")].toInt();
+        entry.result.output = QByteArray::fromBase64(probe[QLatin1String("output")].toString().toLatin1());
+
+        if (!entry.path.isEmpty())
+            cache.insert(cacheKey(entry.path, entry.args), entry);
+    }
+}
+
+/* Called with cacheMutex locked */
+static void store(const QString& path, const QStringList& args, const FileStamp& stamp, const ToolProbe::Result& result)
+{
+    cache.insert(cacheKey(path, args), { path, args, stamp, result });
+    cacheDirty = true;
+}
+
+/** Run a tool to probe what it supports or take the result from the cache.
+
+    @param cmdName the name of the tool
+    @param args the arguments of the probe
+    @return the exit code and output of the tool, not found if it does not exist, did
+            not finish within 30 seconds or if the probe was deferred to the current Batch
+*/
+ToolProbe::Result ToolProbe::run(const QString& cmdName, const QStringList& args)
+{
+    const QString path = findTrustedCommand(cmdName);
+    if (path.isEmpty())
+        return Result();
+
+    const QString key = cacheKey(path, args);
+    const FileStamp stamp = fileStamp(path);
+
+    {
+        QMutexLocker locker(&cacheMutex);
+        loadCache();
+
+        const auto it = cache.constFind(key);
+        if (it != cache.cend() && it->stamp == stamp)
+            return it->result;
+
+        if (currentBatch) {
+            if (!currentBatch->m_Failed.contains(key) && !currentBatch->m_PendingKeys.contains(key)) {
+                currentBatch->m_PendingKeys.insert(key);
+                currentBatch->m_Pending.append(QStringList { path } + args);
+            }
+            return Result();
+        }
+    }
+
+    // ExternalCommand::run() does not enforce its timeout, the helper kills a tool
+    // that runs too long only for commands it runs in parallel
+    const QList<QVariantMap> results = ExternalCommand().runCommands({ QStringList { path } + args }, 1, probeTimeout);
+    Result result;
+    result.found = !results.isEmpty() && results.first()[QStringLiteral("success")].toBool();
+    if (!result.found)
+        return result;
+
+    result.exitCode = results.first()[QStringLiteral("exitCode")].toInt();
+    result.output = results.first()[QStringLiteral("output")].toByteArray();
+
+    QMutexLocker locker(&cacheMutex);
+    store(path, args, stamp, result);
+    return result;
+}
+
+/** Write the cache file if probes were run since it was read. */
+void ToolProbe::save()
+{
+    QMutexLocker locker(&cacheMutex);
+    if (!cacheDirty)
+        return;
+
+    QJsonArray probes;
+    for (const Entry& entry : std::as_const(cache)) {
+        QJsonObject probe;
+        probe[QLatin1String("path")] = entry.path;
+        probe[QLatin1String("args")] = QJsonArray::fromStringList(entry.args);
+        // 64 bit values do not fit into a JSON number
+        probe[QLatin1String("device")] = QString::number(entry.stamp.device);
+        probe[QLatin1String("inode")] = QString::number(entry.stamp.inode);
+        probe[QLatin1String("size")] = QString::number(entry.stamp.size);
+        probe[QLatin1String("mtime")] = QString::number(entry.stamp.mtime);
+        probe[QLatin1String("exitCode")] = entry.result.exitCode;
+        probe[QLatin1String("output")] = QString::fromLatin1(entry.result.output.toBase64());
+        probes.append(probe);
+    }
+
+    QJsonObject root;
+    root[QLatin1String("version")] = cacheVersion;
+    root[QLatin1String("probes")] = probes;
+
+    const QString fileName = cacheFileName();
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(root).toJson(QJsonDocument::Compact)) < 0 || !file.commit()) {
+        qWarning() << "Cannot write tool probe cache" << fileName << file.errorString();
+        return;
+    }
+
+    cacheDirty = false;
+}
+
+/** Defer probes that are not cached in this thread until runPending() is called. */
+ToolProbe::Batch::Batch() :
+    m_Previous(currentBatch)
+{
+    currentBatch = this;
+}
+
+ToolProbe::Batch::~Batch()
+{
+    currentBatch = m_Previous;
+}
+
+/** Run the probes collected since the last call at the same time.
+
+    Probes the helper could not run are reported as not found for the rest of the batch.
+
+    @param maxParallel the maximum number of tools running at the same time
+    @return true if probes were pending, then the callers of run() should probe again
+*/
+bool ToolProbe::Batch::runPending(int maxParallel)
+{
+    if (m_Pending.isEmpty())
+        return false;
+
+    const QList<QStringList> pending = std::exchange(m_Pending, {});
+    m_PendingKeys.clear();
+
+    const QList<QVariantMap> results = ExternalCommand().runCommands(pending, maxParallel, probeTimeout);
+
+    QMutexLocker locker(&cacheMutex);
+    for (qsizetype i = 0; i < pending.size(); ++i) {
+        const QString& path = pending[i].first();
+        const QStringList args = pending[i].mid(1);
+
+        if (i >= results.size() || !results[i][QStringLiteral("success")].toBool()) {
+            m_Failed.insert(cacheKey(path, args));
+            continue;
+        }
+
+        Result result;
+        result.found = true;
+        result.exitCode = results[i][QStringLiteral("exitCode")].toInt();
+        result.output = results[i][QStringLiteral("output")].toByteArray();
+        store(path, args, fileStamp(path), result);
+    }
+
+    return true;
+}
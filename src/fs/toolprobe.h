@@ -0,0 +1,62 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_TOOLPROBE_H
+#define KPMCORE_TOOLPROBE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+/** Cached results of running file system tools to find out what they support.
+
+    FileSystem::init() runs dozens of tools through the helper to see whether they
+    exist and which options they know. The results are kept in a cache file keyed by
+    the path, inode, size and modification time of the tool, so they are only probed
+    again after the tool was installed, upgraded or removed.
+
+    While a Batch exists, probes that are not cached are collected instead of run.
+    Batch::runPending() then runs all of them at the same time.
+
+    @author kpmcore contributors
+*/
+class ToolProbe
+{
+public:
+    struct Result {
+        bool found = false;     /**< the tool exists and could be run */
+        int exitCode = -1;
+        QByteArray output;
+    };
+
+    class Batch
+    {
+        Q_DISABLE_COPY(Batch)
+
+    public:
+        Batch();
+        ~Batch();
+
+    public:
+        bool runPending(int maxParallel = 8);
+
+    private:
+        friend class ToolProbe;
+
+        QList<QStringList> m_Pending;   /**< full path of the tool followed by the arguments */
+        QSet<QString> m_PendingKeys;
+        QSet<QString> m_Failed;         /**< probes the helper could not run */
+        Batch* m_Previous;
+    };
+
+public:
+    static Result run(const QString& cmdName, const QStringList& args = QStringList());
+    static void save();
+};
+
+#endif
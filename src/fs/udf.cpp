@@ -8,6 +8,8 @@
 */
 
 #include "fs/udf.h"
+#include "fs/filesystemfactory.h"
+#include "fs/toolprobe.h"
 
 #include "util/externalcommand.h"
 #include "util/capacity.h"
@@ -44,13 +46,15 @@ void udf::init()
 
     if (m_Create == cmdSupportFileSystem) {
         // Detect old mkudffs prior to version 1.1 by lack of --label option
-        ExternalCommand cmd(QStringLiteral("mkudffs"), { QStringLiteral("--help") });
-        oldMkudffsVersion = cmd.run(-1) && !cmd.output().contains(QStringLiteral("--label"));
+        const ToolProbe::Result probe = ToolProbe::run(QStringLiteral("mkudffs"), { QStringLiteral("--help") });
+        oldMkudffsVersion = probe.found && !probe.output.contains("--label");
     }
 }
 
 bool udf::supportToolFound() const
 {
+    FileSystemFactory::detectSupport(type());
+
     return
         m_GetUsed != cmdSupportNone &&
         m_SetLabel != cmdSupportNone &&
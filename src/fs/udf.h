@@ -42,16 +42,16 @@ public:
     void setPosixPermissions(const QString& permissions) override { implSetPosixPermissions(permissions); };
 
     CommandSupportType supportGetUsed() const override {
-        return m_GetUsed;
+        return probed(m_GetUsed);
     }
     CommandSupportType supportGetLabel() const override {
         return cmdSupportCore;
     }
     CommandSupportType supportCreate() const override {
-        return m_Create;
+        return probed(m_Create);
     }
     CommandSupportType supportCreateWithLabel() const override {
-        return m_Create;
+        return probed(m_Create);
     }
     CommandSupportType supportMove() const override {
         return cmdSupportCore;
@@ -63,10 +63,10 @@ public:
         return cmdSupportCore;
     }
     CommandSupportType supportSetLabel() const override {
-        return m_SetLabel;
+        return probed(m_SetLabel);
     }
     CommandSupportType supportUpdateUUID() const override {
-        return m_UpdateUUID;
+        return probed(m_UpdateUUID);
     }
     CommandSupportType supportGetUUID() const override {
         return cmdSupportCore;
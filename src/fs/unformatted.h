@@ -35,7 +35,7 @@ public:
     bool create(Report&, const QString&) override;
 
     CommandSupportType supportCreate() const override {
-        return m_Create;
+        return probed(m_Create);
     }
 
     bool supportToolFound() const override {
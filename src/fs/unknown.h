@@ -34,11 +34,11 @@ public:
     bool canMount(const QString & deviceNode, const QString & mountPoint) const override;
 
     CommandSupportType supportMove() const override {
-        return m_Move;
+        return probed(m_Move);
     }
 
     CommandSupportType supportCopy() const override {
-        return m_Copy;
+        return probed(m_Copy);
     }
 
     static CommandSupportType m_Move;
@@ -9,6 +9,8 @@
 */
 
 #include "fs/xfs.h"
+#include "fs/filesystemfactory.h"
+#include "fs/superblock.h"
 
 #include "util/externalcommand.h"
 #include "util/capacity.h"
@@ -53,6 +55,8 @@ void xfs::init()
 
 bool xfs::supportToolFound() const
 {
+    FileSystemFactory::detectSupport(type());
+
     return
         m_GetUsed != cmdSupportNone &&
         m_GetLabel != cmdSupportNone &&
@@ -90,6 +94,10 @@ int xfs::maxLabelLength() const
 
 qint64 xfs::readUsedCapacity(const QString& deviceNode) const
 {
+    const qint64 usedBytes = Superblock::xfsUsedBytes(Superblock::read(deviceNode, Superblock::xfsLayout));
+    if (usedBytes > -1)
+        return usedBytes;
+
     ExternalCommand cmd(QStringLiteral("xfs_db"), { QStringLiteral("-c"), QStringLiteral("sb 0"), QStringLiteral("-c"), QStringLiteral("print"), deviceNode });
 
     if (cmd.run(-1) && cmd.exitCode() == 0) {
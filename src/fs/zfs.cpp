@@ -9,6 +9,7 @@
 */
 
 #include "fs/zfs.h"
+#include "fs/filesystemfactory.h"
 
 #include "util/externalcommand.h"
 #include "util/capacity.h"
@@ -47,6 +48,8 @@ void zfs::init()
 
 bool zfs::supportToolFound() const
 {
+    FileSystemFactory::detectSupport(type());
+
     return
 //          m_GetUsed != cmdSupportNone &&
         m_GetLabel != cmdSupportNone &&
@@ -373,8 +373,6 @@ void PartResizerWidget::resizeLogicals(qint64 deltaFirst, qint64 deltaLast, bool
     if (force || deltaFirst != 0 || deltaLast != 0) {
         Q_ASSERT(device().partitionTable());
 
-        device().partitionTable()->removeUnallocated(&partition());
-
         if (partition().roles().has(PartitionRole::Extended))
             device().partitionTable()->insertUnallocated(device(), &partition(), partition().firstSector());
     }
@@ -36,6 +36,8 @@ bool DeactivateLogicalVolumeJob::run(Report& parent)
                 if (!LvmDevice::deactivateLV(*report, *p)) {
                     rval = false;
                 }
+                else
+                    static_cast<const LvmDevice&>(device()).setLVActive(p->partitionPath(), false);
             }
         }
     }
@@ -63,6 +63,10 @@ public:
     virtual QString description() const = 0; /**< @return the Job's description */
     virtual bool run(Report& parent) = 0; /**< @param parent parent Report to add new child to for this Job @return true if successfully run */
 
+    virtual bool changesPartitionTableOnly() const {
+        return false;    /**< @return true if the Job neither needs nor touches device nodes of partitions, see CommitBatch */
+    }
+
     virtual QString statusIcon() const;
     virtual QString statusText() const;
 
@@ -33,6 +33,9 @@ public:
     bool run(Report& parent) override;
     qint32 numSteps() const override;
     QString description() const override;
+    bool changesPartitionTableOnly() const override {
+        return true;
+    }
 
 protected:
     Device& device() {
@@ -69,6 +69,8 @@ bool SetPartGeometryJob::run(Report& parent)
         partition().setLastSector(newStart() + newLength() - 1);
 
         rval = LvmDevice::resizeLV(*report, partition());
+        if (rval)
+            static_cast<LvmDevice&>(device()).setLVSize(partition().partitionPath(), newLength());
     }
 
     jobFinished(*report, rval);
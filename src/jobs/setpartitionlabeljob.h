@@ -26,6 +26,9 @@ public:
 public:
     bool run(Report& parent) override;
     QString description() const override;
+    bool changesPartitionTableOnly() const override {
+        return true;
+    }
 
 protected:
     Partition& partition() {
@@ -115,7 +115,7 @@ bool CopyOperation::execute(Report& parent)
     Report* report = parent.newChild(description());
 
     // check the source first
-    if ((rval = checkSourceJob()->run(*report))) {
+    if ((rval = runJob(checkSourceJob(), *report))) {
         // At this point, if the target partition is to be created and not overwritten, it
         // will still have the wrong device path (the one of the source device). We need
         // to adjust that before we're creating it.
@@ -123,7 +123,7 @@ bool CopyOperation::execute(Report& parent)
 
         // either we have no partition to create (because we're overwriting) or creating
         // must be successful
-        if (!createPartitionJob() || (rval = createPartitionJob()->run(*report))) {
+        if (!createPartitionJob() || (rval = runJob(createPartitionJob(), *report))) {
             // set the state of the target partition from StateCopy to StateNone or checking
             // it will fail (because its deviceNode() will still be "Copy of sdXn"). This is
             // only required for overwritten partitions, but doesn't hurt in any case.
@@ -136,14 +136,14 @@ bool CopyOperation::execute(Report& parent)
             }
 
             // now run the copy job itself
-            if ((rval = copyFSJob()->run(*report))) {
+            if ((rval = runJob(copyFSJob(), *report))) {
                 // and if the copy job succeeded, check the target
-                if ((rval = checkTargetJob()->run(*report))) {
+                if ((rval = runJob(checkTargetJob(), *report))) {
                     // ok, everything went well
                     rval = true;
 
                     // if maximizing doesn't work, just warn the user, don't fail
-                    if (!maximizeJob()->run(*report)) {
+                    if (!runJob(maximizeJob(), *report)) {
                         report->line() << xi18nc("@info:status", "<warning>Maximizing file system on target partition <filename>%1</filename> to the size of the partition failed.</warning>", copiedPartition().deviceNode());
                         warning = true;
                     }
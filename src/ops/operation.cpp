@@ -7,6 +7,8 @@
 
 #include "ops/operation_p.h"
 
+#include "backend/commitbatch.h"
+
 #include "core/partition.h"
 #include "core/device.h"
 #include "core/lvmdevice.h"
@@ -38,8 +40,7 @@ void Operation::insertPreviewPartition(Device& device, Partition& p)
 {
     Q_ASSERT(device.partitionTable());
 
-    device.partitionTable()->removeUnallocated();
-
+    // The unallocated partition p is inserted over is moved or deleted by updateUnallocated()
     if (p.parent()->insert(&p)) {
         if (device.type() == Device::Type::LVM_Device) {
             const LvmDevice& lvm = static_cast<const LvmDevice&>(device);
@@ -166,7 +167,7 @@ bool Operation::execute(Report& parent)
 
     const auto Jobs = jobs();
     for (const auto &job : Jobs)
-        if (!(rval = job->run(*report)))
+        if (!(rval = runJob(job, *report)))
             break;
 
     setStatus(rval ? StatusFinishedSuccess : StatusError);
@@ -176,6 +177,24 @@ bool Operation::execute(Report& parent)
     return rval;
 }
 
+/** Run one of the Operation's Jobs.
+
+    Partitions created or moved by earlier Jobs have to show up before a Job that uses
+    their device nodes runs, so pending commits of the CommitBatch are flushed first.
+    Operations overriding execute() must run their Jobs with this method.
+
+    @param job the Job to run
+    @param report the Report to write to
+    @return true on success
+*/
+bool Operation::runJob(Job* job, Report& report)
+{
+    if (!job->changesPartitionTableOnly() && !CommitBatch::flush(report))
+        return false;
+
+    return job->run(report);
+}
+
 Operation::OperationStatus Operation::status() const
 {
     return d->m_Status;
@@ -121,6 +121,7 @@ protected:
     void removePreviewPartition(Device& device, Partition& p);
 
     void addJob(Job* job);
+    bool runJob(Job* job, Report& report);
 
     QList<Job*>& jobs();
     const QList<Job*>& jobs() const;
@@ -144,7 +144,7 @@ bool ResizeOperation::execute(Report& parent)
     Report* report = parent.newChild(description());
 
     if (CheckOperation::canCheck(&partition()))
-        rval = checkOriginalJob()->run(*report);
+        rval = runJob(checkOriginalJob(), *report);
 
     if (rval) {
         // Extended partitions are a special case: They don't have any file systems and so there's no
@@ -152,7 +152,7 @@ bool ResizeOperation::execute(Report& parent)
         // to first shrink THEN move would not work for an extended partition that has children, because
         // they might temporarily be outside the extended partition and the backend would not let us do that.
         if (moveExtendedJob()) {
-            if (!(rval = moveExtendedJob()->run(*report)))
+            if (!(rval = runJob(moveExtendedJob(), *report)))
                 report->line() << xi18nc("@info:status", "Moving extended partition <filename>%1</filename> failed.", partition().deviceNode());
         } else {
             // We run all three methods. Any of them returns true if it has nothing to do.
@@ -160,7 +160,7 @@ bool ResizeOperation::execute(Report& parent)
 
             if (rval) {
                 if (CheckOperation::canCheck(&partition())) {
-                    rval = checkResizedJob()->run(*report);
+                    rval = runJob(checkResizedJob(), *report);
                     if (!rval)
                         report->line() << xi18nc("@info:status", "Checking partition <filename>%1</filename> after resize/move failed.", partition().deviceNode());
                 }
@@ -254,12 +254,12 @@ ResizeOperation::ResizeAction ResizeOperation::resizeAction() const
 
 bool ResizeOperation::shrink(Report& report)
 {
-    if (shrinkResizeJob() && !shrinkResizeJob()->run(report)) {
+    if (shrinkResizeJob() && !runJob(shrinkResizeJob(), report)) {
         report.line() << xi18nc("@info:status", "Resize/move failed: Could not resize file system to shrink partition <filename>%1</filename>.", partition().deviceNode());
         return false;
     }
 
-    if (shrinkSetGeomJob() && !shrinkSetGeomJob()->run(report)) {
+    if (shrinkSetGeomJob() && !runJob(shrinkSetGeomJob(), report)) {
         report.line() << xi18nc("@info:status", "Resize/move failed: Could not shrink partition <filename>%1</filename>.", partition().deviceNode());
         return false;
 
@@ -278,12 +278,12 @@ bool ResizeOperation::move(Report& report)
     // only afterwards copy the filesystem. Disadvantage: We need to move the partition
     // back to its original position if copyBlocks fails.
     const qint64 oldStart = partition().firstSector();
-    if (moveSetGeomJob() && !moveSetGeomJob()->run(report)) {
+    if (moveSetGeomJob() && !runJob(moveSetGeomJob(), report)) {
         report.line() << xi18nc("@info:status", "Moving partition <filename>%1</filename> failed.", partition().deviceNode());
         return false;
     }
 
-    if (moveFileSystemJob() && !moveFileSystemJob()->run(report)) {
+    if (moveFileSystemJob() && !runJob(moveFileSystemJob(), report)) {
         report.line() << xi18nc("@info:status", "Moving the filesystem for partition <filename>%1</filename> failed. Rolling back.", partition().deviceNode());
 
         // see above: We now have to move back the partition itself.
@@ -300,12 +300,12 @@ bool ResizeOperation::grow(Report& report)
 {
     const qint64 oldLength = partition().length();
 
-    if (growSetGeomJob() && !growSetGeomJob()->run(report)) {
+    if (growSetGeomJob() && !runJob(growSetGeomJob(), report)) {
         report.line() << xi18nc("@info:status", "Resize/move failed: Could not grow partition <filename>%1</filename>.", partition().deviceNode());
         return false;
     }
 
-    if (growResizeJob() && !growResizeJob()->run(report)) {
+    if (growResizeJob() && !runJob(growResizeJob(), report)) {
         report.line() << xi18nc("@info:status", "Resize/move failed: Could not resize the file system on partition <filename>%1</filename>", partition().deviceNode());
 
         if (!SetPartGeometryJob(targetDevice(), partition(), partition().firstSector(), oldLength).run(report))
@@ -118,16 +118,16 @@ bool RestoreOperation::execute(Report& parent)
     if (overwrittenPartition())
         restorePartition().setPartitionPath(overwrittenPartition()->partitionPath());
 
-    if (overwrittenPartition() || (rval = createPartitionJob()->run(*report))) {
+    if (overwrittenPartition() || (rval = runJob(createPartitionJob(), *report))) {
         restorePartition().setState(Partition::State::None);
 
-        if ((rval = restoreJob()->run(*report))) {
-            if ((rval = checkTargetJob()->run(*report))) {
+        if ((rval = runJob(restoreJob(), *report))) {
+            if ((rval = runJob(checkTargetJob(), *report))) {
                 // If the partition was written over an existing one, the partition itself may now
                 // be larger than the filesystem, so maximize the filesystem to the partition's size
                 // or the image length, whichever is larger. If this fails, don't return an error, just
                 // warn the user.
-                if ((warning = !maximizeJob()->run(*report)))
+                if ((warning = !runJob(maximizeJob(), *report)))
                     report->line() << xi18nc("@info:status", "<warning>Maximizing file system on target partition <filename>%1</filename> to the size of the partition failed.</warning>", restorePartition().deviceNode());
             } else
                 report->line() << xi18nc("@info:status", "Checking target file system on partition <filename>%1</filename> after the restore failed.", restorePartition().deviceNode());
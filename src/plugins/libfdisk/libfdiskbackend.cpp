@@ -0,0 +1,583 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+/** @file
+*/
+
+#include "plugins/libfdisk/libfdiskbackend.h"
+#include "plugins/libfdisk/libfdiskdevice.h"
+
+#include "core/diskdevice.h"
+#include "core/lvmdevice.h"
+#include "core/lvmreport.h"
+#include "core/mountindex.h"
+#include "core/partitiontable.h"
+#include "core/partitionalignment.h"
+#include "core/raid/softwareraid.h"
+#include "core/usedspacereader.h"
+
+#include "fs/filesystemfactory.h"
+#include "fs/luks.h"
+#include "fs/luks2.h"
+
+#include "util/globallog.h"
+#include "util/lvmshell.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStorageInfo>
+#include <QString>
+#include <QStringList>
+
+#include <KLocalizedString>
+#include <KPluginFactory>
+
+#include <blkid/blkid.h>
+#include <libfdisk/libfdisk.h>
+
+#include <cstdlib>
+
+K_PLUGIN_CLASS_WITH_JSON(LibfdiskBackend, "pmlibfdiskbackendplugin.json")
+
+LibfdiskBackend::LibfdiskBackend(QObject*, const QList<QVariant>&) :
+    CoreBackend(),
+    m_Scanning(false)
+{
+}
+
+LibfdiskBackend::~LibfdiskBackend()
+{
+}
+
+void LibfdiskBackend::initFSSupport()
+{
+}
+
+/** @return the trimmed content of a sysfs attribute or an empty array if it does not exist */
+QByteArray LibfdiskBackend::readAttribute(const QString& fileName)
+{
+    QFile f(fileName);
+    if (!f.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    return f.readAll().trimmed();
+}
+
+/* Lists the same devices as lsblk would report with type "disk" or, if asked for,
+ * "loop": everything in /sys/block except device mapper devices, Software RAID arrays,
+ * optical drives and devices without media.
+ */
+QList<Device*> LibfdiskBackend::scanDevices(const ScanFlags scanFlags)
+{
+    const bool includeReadOnly = scanFlags.testFlag(ScanFlag::includeReadOnly);
+    const bool includeLoopback = scanFlags.testFlag(ScanFlag::includeLoopback);
+
+    // Read the mount table and fstab once for all partitions found during this scan
+    const MountIndex mountIndex;
+
+    // Query LVM once for the PVs found on disks and the VGs scanned afterwards
+    const LvmReport lvmReport;
+
+    // LVs are activated with one lvm process
+    const LvmShell lvmShell;
+
+    QList<Device*> result;
+    QStringList deviceNodes;
+
+    const QDir sysBlock(QStringLiteral("/sys/block"));
+    const QStringList names = sysBlock.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    for (const QString& name : names) {
+        const QString dir = sysBlock.filePath(name) + QLatin1Char('/');
+
+        if (QFileInfo::exists(dir + QStringLiteral("dm")) || QFileInfo::exists(dir + QStringLiteral("md")))
+            continue;
+        if (!includeLoopback && QFileInfo::exists(dir + QStringLiteral("loop")))
+            continue;
+        if (readAttribute(dir + QStringLiteral("device/type")) == "5") // SCSI type of CD/DVD drives
+            continue;
+        if (readAttribute(dir + QStringLiteral("size")).toLongLong() == 0)
+            continue;
+        if (!includeReadOnly && readAttribute(dir + QStringLiteral("ro")).toInt() == 1)
+            continue;
+
+        QString deviceNode = name;
+        deviceNodes << QStringLiteral("/dev/") + deviceNode.replace(QLatin1Char('!'), QLatin1Char('/'));
+    }
+
+    int totalDevices = deviceNodes.length();
+    for (int i = 0; i < totalDevices; ++i) {
+        const QString deviceNode = deviceNodes[i];
+
+        emitScanProgress(deviceNode, i * 100 / totalDevices);
+        Device* device = scanDevice(deviceNode);
+        if (device != nullptr) {
+            result.append(device);
+        }
+    }
+
+    VolumeManagerDevice::scanDevices(result); // scan all types of VolumeManagerDevices
+
+    return result;
+}
+
+/** Create a Device for the given device_node and scan it for partitions.
+    @param deviceNode the device node (e.g. "/dev/sda")
+    @return the created Device object. callers need to free this.
+*/
+Device* LibfdiskBackend::scanDevice(const QString& deviceNode)
+{
+    const QString kernelName = QFileInfo(deviceNode).canonicalFilePath().section(QLatin1Char('/'), -1);
+    const QString dir = QStringLiteral("/sys/class/block/") + kernelName + QLatin1Char('/');
+
+    if (kernelName.isEmpty() || !QFileInfo::exists(dir + QStringLiteral("size"))) {
+        // Look if this device is a LVM VG
+        const QList<Device*> availableDevices = scanDevices();
+
+        for (Device *device : availableDevices)
+            if (device->deviceNode() == deviceNode)
+                return device;
+
+        return nullptr;
+    }
+
+    // sysfs counts in 512 byte sectors regardless of the device
+    const qint64 deviceSize = readAttribute(dir + QStringLiteral("size")).toLongLong() * 512;
+    const int logicalSectorSize = readAttribute(dir + QStringLiteral("queue/logical_block_size")).toInt();
+    if (deviceSize <= 0 || logicalSectorSize <= 0)
+        return nullptr;
+
+    Device* d = nullptr;
+    if (QFileInfo::exists(dir + QStringLiteral("md"))) {
+        Log(Log::Level::information) << xi18nc("@info:status", "Software RAID Device found: %1", deviceNode);
+        d = new SoftwareRAID(QString(deviceNode).remove(QStringLiteral("/dev/")), SoftwareRAID::Status::Active);
+    }
+    else {
+        QString name = QString::fromUtf8(readAttribute(dir + QStringLiteral("device/model"))).replace(QLatin1Char('_'), QLatin1Char(' ')).trimmed();
+        if (name.isEmpty())
+            name = kernelName;
+
+        QString icon;
+        if (QFileInfo(dir).canonicalFilePath().contains(QStringLiteral("/usb")))
+            icon = QStringLiteral("drive-removable-media-usb");
+
+        Log(Log::Level::information) << xi18nc("@info:status", "Device found: %1", name);
+
+        d = new DiskDevice(name, deviceNode, logicalSectorSize, deviceSize / logicalSectorSize, icon);
+    }
+
+    // Type, label and UUID of every partition are probed once for the whole scan
+    m_Scanning = true;
+    const bool scanned = scanPartitionTable(*d);
+    m_Scanning = false;
+    m_Probes.clear();
+
+    if (!scanned) {
+        delete d;
+        return nullptr;
+    }
+
+    return d;
+}
+
+/** Creates the PartitionTable of a Device from what libfdisk reads from it.
+    @param d the Device to scan
+    @return false if the device could not be read or the partition table could not be set up
+*/
+bool LibfdiskBackend::scanPartitionTable(Device& d)
+{
+    fdisk_context* cxt = openContext(d.deviceNode(), true);
+    if (!cxt) {
+        Log(Log::Level::warning) << xi18nc("@info:status", "Could not read the partition table of device <filename>%1</filename>.", d.deviceNode());
+        return false;
+    }
+
+    if (!fdisk_has_label(cxt)) {
+        closeContext(cxt);
+        scanWholeDevicePartition(d);
+        return true;
+    }
+
+    const PartitionTable::TableType type = PartitionTable::nameToTableType(QString::fromLatin1(fdisk_label_get_name(fdisk_get_label(cxt, nullptr))));
+
+    /* Workaround for whole device FAT partitions */
+    if (type == PartitionTable::msdos) {
+        scanWholeDevicePartition(d);
+        if (d.partitionTable()) {
+            closeContext(cxt);
+            return true;
+        }
+    }
+
+    qint64 firstUsableSector = 0;
+    qint64 lastUsableSector = 0;
+
+    if (d.type() == Device::Type::Disk_Device)
+        lastUsableSector = static_cast<const DiskDevice&>(d).totalSectors();
+    else if (d.type() == Device::Type::SoftwareRAID_Device)
+        lastUsableSector = d.totalLogical() - 1;
+
+    if (type == PartitionTable::gpt) {
+        firstUsableSector = fdisk_get_first_lba(cxt);
+        lastUsableSector = fdisk_get_last_lba(cxt);
+    }
+
+    if (lastUsableSector < firstUsableSector) {
+        closeContext(cxt);
+        return false;
+    }
+
+    setPartitionTableForDevice(d, new PartitionTable(type, firstUsableSector, lastUsableSector));
+    if (type == PartitionTable::gpt)
+        CoreBackend::setPartitionTableMaxPrimaries(*d.partitionTable(), fdisk_get_npartitions(cxt));
+
+    // Extended partitions come before the logical partitions in them
+    QList<Partition*> partitions;
+    fdisk_table* table = nullptr;
+    if (fdisk_get_partitions(cxt, &table) == 0) {
+        fdisk_iter* itr = fdisk_new_iter(FDISK_ITER_FORWARD);
+        fdisk_partition* pa = nullptr;
+
+        while (fdisk_table_next_partition(table, itr, &pa) == 0) {
+            if (!fdisk_partition_has_partno(pa) || !fdisk_partition_has_start(pa) || !fdisk_partition_has_size(pa))
+                continue;
+
+            const size_t partno = fdisk_partition_get_partno(pa);
+            const qint64 start = fdisk_partition_get_start(pa);
+            const qint64 lastSector = start + fdisk_partition_get_size(pa) - 1;
+
+            QString partitionType;
+            if (fdisk_parttype* t = fdisk_partition_get_type(pa))
+                partitionType = type == PartitionTable::gpt ? QString::fromLatin1(fdisk_parttype_get_string(t)) : QString::number(fdisk_parttype_get_code(t), 16);
+
+            Partition* part = scanPartition(d, partitionNode(d.deviceNode(), partno + 1), start, lastSector, partitionType,
+                                            fdisk_partition_is_bootable(pa) == 1, fdisk_partition_is_container(pa) == 1);
+
+            if (!part->roles().has(PartitionRole::Luks))
+                readSectorsUsed(d, *part, part->mountPoint());
+
+            if (type == PartitionTable::gpt) {
+                uint64_t attrs = 0;
+                fdisk_gpt_get_partition_attrs(cxt, partno, &attrs);
+
+                part->setLabel(QString::fromUtf8(fdisk_partition_get_name(pa)));
+                part->setUUID(QString::fromLatin1(fdisk_partition_get_uuid(pa)));
+                part->setType(partitionType);
+                part->setAttributes(attrs);
+            }
+
+            partitions.append(part);
+        }
+
+        fdisk_free_iter(itr);
+        fdisk_unref_table(table);
+    }
+    closeContext(cxt);
+
+    d.partitionTable()->updateUnallocated(d);
+    d.partitionTable()->setType(d, d.partitionTable()->type());
+
+    for (const Partition *part : std::as_const(partitions))
+        PartitionAlignment::isAligned(d, *part);
+
+    return true;
+}
+
+/** Scans a Device for FileSystems spanning the whole block device
+
+    This method  will scan a Device for a FileSystem.
+    It tries to determine the FileSystem usage, reads the FileSystem label and creates
+    PartitionTable of type "none" and a single Partition object.
+*/
+void LibfdiskBackend::scanWholeDevicePartition(Device& d) {
+    const QString partitionNode = d.deviceNode();
+    constexpr qint64 firstSector = 0;
+    const qint64 lastSector = d.totalLogical() - 1;
+    setPartitionTableForDevice(d, new PartitionTable(PartitionTable::TableType::none, firstSector, lastSector));
+    Partition *partition = scanPartition(d, partitionNode, firstSector, lastSector, QString(), false, false);
+
+    if (partition->fileSystem().type() == FileSystem::Type::Unknown) {
+        delete d.partitionTable();
+        setPartitionTableForDevice(d, nullptr);
+        return;
+    }
+
+    if (!partition->roles().has(PartitionRole::Luks))
+        readSectorsUsed(d, *partition, partition->mountPoint());
+}
+
+Partition* LibfdiskBackend::scanPartition(Device& d, const QString& partitionNode, const qint64 firstSector, const qint64 lastSector, const QString& partitionType, const bool bootable, const bool extended)
+{
+    PartitionTable::Flags activeFlags = bootable ? PartitionTable::Flag::Boot : PartitionTable::Flag::None;
+    if (partitionType == QStringLiteral("C12A7328-F81F-11D2-BA4B-00A0C93EC93B"))
+        activeFlags |= PartitionTable::Flag::Boot;
+    else if (partitionType == QStringLiteral("21686148-6449-6E6F-744E-656564454649"))
+        activeFlags |= PartitionTable::Flag::BiosGrub;
+
+    PartitionRole::Roles r = extended ? PartitionRole::Extended : PartitionRole::Primary;
+    const FileSystem::Type type = extended ? FileSystem::Type::Extended : detectFileSystem(partitionNode);
+
+    // Find an extended partition this partition is in.
+    PartitionNode* parent = d.partitionTable()->findPartitionBySector(firstSector, PartitionRole(PartitionRole::Extended));
+
+    // None found, so it's a primary in the device's partition table.
+    if (parent == nullptr)
+        parent = d.partitionTable();
+    else
+        r = PartitionRole::Logical;
+
+    FileSystem* fs = FileSystemFactory::create(type, firstSector, lastSector, d.logicalSize());
+    fs->scan(partitionNode);
+
+    QString mountPoint;
+    bool mounted;
+    // libfdisk does not handle LUKS partitions
+    if (fs->type() == FileSystem::Type::Luks || fs->type() == FileSystem::Type::Luks2) {
+        r |= PartitionRole::Luks;
+        FS::luks* luksFs = static_cast<FS::luks*>(fs);
+        luksFs->initLUKS();
+        QString mapperNode = luksFs->mapperName();
+        mountPoint = FileSystem::detectMountPoint(fs, mapperNode);
+        mounted    = FileSystem::detectMountStatus(fs, mapperNode);
+    } else {
+        mountPoint = FileSystem::detectMountPoint(fs, partitionNode);
+        mounted = FileSystem::detectMountStatus(fs, partitionNode);
+    }
+
+    Partition* partition = new Partition(parent, d, PartitionRole(r), fs, firstSector, lastSector, partitionNode, availableFlags(d.partitionTable()->type()), mountPoint, mounted, activeFlags);
+
+    if (fs->supportGetLabel() != FileSystem::cmdSupportNone)
+        fs->setLabel(fs->readLabel(partition->deviceNode()));
+
+    if (fs->supportGetUUID() != FileSystem::cmdSupportNone)
+        fs->setUUID(fs->readUUID(partition->deviceNode()));
+
+    parent->append(partition);
+    return partition;
+}
+
+/** Reads the sectors used in a FileSystem and stores the result in the Partition's FileSystem object.
+    @param p the Partition the FileSystem is on
+    @param mountPoint mount point of the partition in question
+*/
+void LibfdiskBackend::readSectorsUsed(const Device& d, Partition& p, const QString& mountPoint)
+{
+    if (p.isFileSystemNullptr())
+        return;
+    if (!mountPoint.isEmpty() && p.fileSystem().type() != FileSystem::Type::LinuxSwap && p.fileSystem().type() != FileSystem::Type::Lvm2_PV) {
+        const QStorageInfo storage = QStorageInfo(mountPoint);
+        if (p.isMounted() && storage.isValid())
+            p.fileSystem().setSectorsUsed( (storage.bytesTotal() - storage.bytesFree()) / d.logicalSize());
+    }
+    else if (p.fileSystem().supportGetUsed() == FileSystem::cmdSupportFileSystem) {
+        if (UsedSpaceReader* reader = UsedSpaceReader::current())
+            reader->enqueue(p);
+        else
+            p.fileSystem().setSectorsUsed(p.fileSystem().readUsedCapacity(p.deviceNode()) / d.logicalSize());
+    }
+}
+
+/** Probes a device for a file system with libblkid.
+
+    While a device is scanned, the result is kept so type, label and UUID of a
+    partition are read with one probe.
+
+    @param deviceNode the device to probe
+    @return the values found, empty if there is no file system or it could not be read
+*/
+LibfdiskBackend::Probe LibfdiskBackend::probe(const QString& deviceNode) const
+{
+    if (m_Scanning) {
+        const auto it = m_Probes.constFind(deviceNode);
+        if (it != m_Probes.cend())
+            return *it;
+    }
+
+    Probe result;
+    if (blkid_probe pr = blkid_new_probe_from_filename(QFile::encodeName(deviceNode).constData())) {
+        blkid_probe_enable_superblocks(pr, 1);
+        blkid_probe_set_superblocks_flags(pr, BLKID_SUBLKS_TYPE | BLKID_SUBLKS_SECTYPE | BLKID_SUBLKS_VERSION |
+                                              BLKID_SUBLKS_LABEL | BLKID_SUBLKS_UUID);
+
+        if (blkid_do_safeprobe(pr) == 0) {
+            auto value = [pr] (const char* name) {
+                const char* data = nullptr;
+                return blkid_probe_lookup_value(pr, name, &data, nullptr) == 0 ? QString::fromUtf8(data) : QString();
+            };
+
+            result.type = value("TYPE");
+            result.version = value("VERSION");
+            // Older libblkid only tells FAT12 and FAT16 apart from FAT32 with SEC_TYPE=msdos
+            if (result.version.isEmpty())
+                result.version = value("SEC_TYPE");
+            result.label = value("LABEL");
+            result.uuid = value("UUID");
+        }
+
+        blkid_free_probe(pr);
+    }
+
+    if (m_Scanning)
+        m_Probes.insert(deviceNode, result);
+
+    return result;
+}
+
+FileSystem::Type LibfdiskBackend::detectFileSystem(const QString& partitionPath)
+{
+    const Probe p = probe(partitionPath);
+    const FileSystem::Type rval = fileSystemNameToType(p.type, p.version);
+
+    if (rval == FileSystem::Type::Unknown) {
+        qWarning() << "unknown file system type " << p.type << " on " << partitionPath;
+    }
+    return rval;
+}
+
+FileSystem::Type LibfdiskBackend::fileSystemNameToType(const QString& name, const QString& version)
+{
+    FileSystem::Type rval = FileSystem::Type::Unknown;
+
+    if (name == QStringLiteral("ext2")) rval = FileSystem::Type::Ext2;
+    else if (name == QStringLiteral("ext3")) rval = FileSystem::Type::Ext3;
+    else if (name.startsWith(QStringLiteral("ext4"))) rval = FileSystem::Type::Ext4;
+    else if (name == QStringLiteral("swap")) rval = FileSystem::Type::LinuxSwap;
+    else if (name == QStringLiteral("ntfs")) rval = FileSystem::Type::Ntfs;
+    else if (name == QStringLiteral("reiserfs")) rval = FileSystem::Type::ReiserFS;
+    else if (name == QStringLiteral("reiser4")) rval = FileSystem::Type::Reiser4;
+    else if (name == QStringLiteral("xfs")) rval = FileSystem::Type::Xfs;
+    else if (name == QStringLiteral("jfs")) rval = FileSystem::Type::Jfs;
+    else if (name == QStringLiteral("hfs")) rval = FileSystem::Type::Hfs;
+    else if (name == QStringLiteral("hfsplus")) rval = FileSystem::Type::HfsPlus;
+    else if (name == QStringLiteral("ufs")) rval = FileSystem::Type::Ufs;
+    else if (name == QStringLiteral("vfat")) {
+        if (version == QStringLiteral("FAT32"))
+            rval = FileSystem::Type::Fat32;
+        else if (version == QStringLiteral("FAT16") || version == QStringLiteral("msdos")) // blkid uses msdos for both FAT16 and FAT12
+            rval = FileSystem::Type::Fat16;
+        else if (version == QStringLiteral("FAT12"))
+            rval = FileSystem::Type::Fat12;
+    }
+    else if (name == QStringLiteral("btrfs")) rval = FileSystem::Type::Btrfs;
+    else if (name == QStringLiteral("ocfs2")) rval = FileSystem::Type::Ocfs2;
+    else if (name == QStringLiteral("zfs_member")) rval = FileSystem::Type::Zfs;
+    else if (name == QStringLiteral("hpfs")) rval = FileSystem::Type::Hpfs;
+    else if (name == QStringLiteral("crypto_LUKS")) {
+        if (version == QStringLiteral("1"))
+            rval = FileSystem::Type::Luks;
+        else if (version == QStringLiteral("2")) {
+            rval = FileSystem::Type::Luks2;
+        }
+    }
+    else if (name == QStringLiteral("exfat")) rval = FileSystem::Type::Exfat;
+    else if (name == QStringLiteral("nilfs2")) rval = FileSystem::Type::Nilfs2;
+    else if (name == QStringLiteral("LVM2_member")) rval = FileSystem::Type::Lvm2_PV;
+    else if (name == QStringLiteral("f2fs")) rval = FileSystem::Type::F2fs;
+    else if (name == QStringLiteral("udf")) rval = FileSystem::Type::Udf;
+    else if (name == QStringLiteral("iso9660")) rval = FileSystem::Type::Iso9660;
+    else if (name == QStringLiteral("linux_raid_member")) rval = FileSystem::Type::LinuxRaidMember;
+    else if (name == QStringLiteral("BitLocker")) rval = FileSystem::Type::BitLocker;
+    else if (name == QStringLiteral("apfs")) rval = FileSystem::Type::Apfs;
+    else if (name == QStringLiteral("minix")) rval = FileSystem::Type::Minix;
+    else if (name == QStringLiteral("bcachefs")) rval = FileSystem::Type::Bcachefs;
+
+    return rval;
+}
+
+QString LibfdiskBackend::readLabel(const QString& deviceNode) const
+{
+    return probe(deviceNode).label;
+}
+
+QString LibfdiskBackend::readUUID(const QString& deviceNode) const
+{
+    return probe(deviceNode).uuid;
+}
+
+PartitionTable::Flags LibfdiskBackend::availableFlags(PartitionTable::TableType type)
+{
+    PartitionTable::Flags flags;
+    if (type == PartitionTable::gpt) {
+        // These are not really flags but for now keep them for compatibility
+        // We should implement changing partition type
+        flags = PartitionTable::Flag::BiosGrub |
+                PartitionTable::Flag::Boot;
+    }
+    else if (type == PartitionTable::msdos)
+        flags = PartitionTable::Flag::Boot;
+
+    return flags;
+}
+
+/** Assigns a device to a new libfdisk context.
+    @param deviceNode the device to open
+    @param readOnly true to only read the partition table
+    @return the context or nullptr if the device could not be opened, free it with closeContext()
+*/
+fdisk_context* LibfdiskBackend::openContext(const QString& deviceNode, bool readOnly)
+{
+    fdisk_context* cxt = fdisk_new_context();
+    if (!cxt)
+        return nullptr;
+
+    if (fdisk_assign_device(cxt, QFile::encodeName(deviceNode).constData(), readOnly ? 1 : 0) != 0) {
+        qWarning() << "libfdisk could not open" << deviceNode;
+        fdisk_unref_context(cxt);
+        return nullptr;
+    }
+
+    return cxt;
+}
+
+/** Flushes what was written through a context to the device and frees it. */
+void LibfdiskBackend::closeContext(fdisk_context* cxt)
+{
+    if (!cxt)
+        return;
+
+    fdisk_deassign_device(cxt, 0);
+    fdisk_unref_context(cxt);
+}
+
+/** @return the device node of partition number of a device, e.g. /dev/nvme0n1p2 */
+QString LibfdiskBackend::partitionNode(const QString& deviceNode, int number)
+{
+    char* name = fdisk_partname(QFile::encodeName(deviceNode).constData(), number);
+    if (!name)
+        return QString();
+
+    const QString node = QFile::decodeName(name);
+    free(name);
+    return node;
+}
+
+std::unique_ptr<CoreBackendDevice> LibfdiskBackend::openDevice(const Device& d)
+{
+    std::unique_ptr<LibfdiskDevice> device = std::make_unique<LibfdiskDevice>(d);
+
+    if (!device->open())
+        device = nullptr;
+
+    return device;
+}
+
+std::unique_ptr<CoreBackendDevice> LibfdiskBackend::openDeviceExclusive(const Device& d)
+{
+    std::unique_ptr<LibfdiskDevice> device = std::make_unique<LibfdiskDevice>(d);
+
+    if (!device->openExclusive())
+        device = nullptr;
+
+    return device;
+}
+
+bool LibfdiskBackend::closeDevice(std::unique_ptr<CoreBackendDevice> coreDevice)
+{
+    return coreDevice->close();
+}
+
+#include "libfdiskbackend.moc"
@@ -0,0 +1,86 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef LIBFDISKBACKEND__H
+#define LIBFDISKBACKEND__H
+
+#include "backend/corebackend.h"
+#include "core/partition.h"
+#include "fs/filesystem.h"
+
+#include <memory>
+
+#include <QHash>
+#include <QList>
+#include <QVariant>
+
+class Device;
+class Partition;
+class KPluginFactory;
+class QString;
+
+struct fdisk_context;
+
+/** Backend plugin for libfdisk
+
+    Reads and writes partition tables with libfdisk and detects file systems with
+    libblkid in the calling process, without running sfdisk, lsblk, blockdev or
+    udevadm and parsing their output. Devices are found in sysfs.
+
+    As nothing goes through the helper, the process needs read access to the block
+    devices to scan them and has to run as root to change them, so this backend is
+    meant for installers and other privileged clients.
+
+    @author kpmcore contributors
+*/
+class LibfdiskBackend : public CoreBackend
+{
+    Q_DISABLE_COPY(LibfdiskBackend)
+
+public:
+    LibfdiskBackend(QObject* parent, const QList<QVariant>& args);
+    ~LibfdiskBackend() override;
+
+public:
+    void initFSSupport() override;
+
+    QList<Device*> scanDevices(const ScanFlags scanFlags = {}) override;
+    std::unique_ptr<CoreBackendDevice> openDevice(const Device& d) override;
+    std::unique_ptr<CoreBackendDevice> openDeviceExclusive(const Device& d) override;
+    bool closeDevice(std::unique_ptr<CoreBackendDevice> coreDevice) override;
+    Device* scanDevice(const QString& deviceNode) override;
+    FileSystem::Type detectFileSystem(const QString& partitionPath) override;
+    QString readLabel(const QString& deviceNode) const override;
+    QString readUUID(const QString& deviceNode) const override;
+
+    static fdisk_context* openContext(const QString& deviceNode, bool readOnly);
+    static void closeContext(fdisk_context* cxt);
+    static QString partitionNode(const QString& deviceNode, int number);
+    static QByteArray readAttribute(const QString& fileName);
+
+private:
+    /** Values libblkid found on a device */
+    struct Probe {
+        QString type;
+        QString version;
+        QString label;
+        QString uuid;
+    };
+
+    Probe probe(const QString& deviceNode) const;
+    void readSectorsUsed(const Device& d, Partition& p, const QString& mountPoint);
+    bool scanPartitionTable(Device& d);
+    Partition* scanPartition(Device& d, const QString& partitionNode, const qint64 firstSector, const qint64 lastSector, const QString& partitionType, const bool bootable, const bool extended);
+    void scanWholeDevicePartition(Device& d);
+    static PartitionTable::Flags availableFlags(PartitionTable::TableType type);
+    static FileSystem::Type fileSystemNameToType(const QString& fileSystemName, const QString& version);
+
+private:
+    mutable QHash<QString, Probe> m_Probes; /**< probe results of the device being scanned */
+    bool m_Scanning;
+};
+
+#endif
@@ -0,0 +1,83 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "plugins/libfdisk/libfdiskbackend.h"
+#include "plugins/libfdisk/libfdiskdevice.h"
+#include "plugins/libfdisk/libfdiskpartitiontable.h"
+
+#include "core/partitiontable.h"
+
+#include "util/report.h"
+
+#include <KLocalizedString>
+
+#include <libfdisk/libfdisk.h>
+
+LibfdiskDevice::LibfdiskDevice(const Device& d) :
+    CoreBackendDevice(d.deviceNode()),
+    m_device(&d)
+{
+}
+
+LibfdiskDevice::~LibfdiskDevice()
+{
+    close();
+}
+
+bool LibfdiskDevice::open()
+{
+    return true;
+}
+
+bool LibfdiskDevice::openExclusive()
+{
+    setExclusive(true);
+
+    return true;
+}
+
+bool LibfdiskDevice::close()
+{
+    if (isExclusive())
+        setExclusive(false);
+
+    CoreBackendPartitionTable* ptable = new LibfdiskPartitionTable(m_device);
+    ptable->commit();
+    delete ptable;
+
+    return true;
+}
+
+std::unique_ptr<CoreBackendPartitionTable> LibfdiskDevice::openPartitionTable()
+{
+    return std::make_unique<LibfdiskPartitionTable>(m_device);
+}
+
+bool LibfdiskDevice::createPartitionTable(Report& report, const PartitionTable& ptable)
+{
+    QByteArray tableType;
+    if (ptable.type() == PartitionTable::msdos)
+        tableType = QByteArrayLiteral("dos");
+    else
+        tableType = ptable.typeName().toLocal8Bit();
+
+    fdisk_context* cxt = LibfdiskBackend::openContext(m_device->deviceNode(), false);
+    if (!cxt) {
+        report.line() << xi18nc("@info:progress", "Could not open device <filename>%1</filename> to create a new partition table.", m_device->deviceNode());
+        return false;
+    }
+
+    // Like sfdisk --wipe=always, remove signatures of file systems and other tables
+    fdisk_enable_wipe(cxt, 1);
+
+    const bool rval = fdisk_create_disklabel(cxt, tableType.constData()) == 0 && fdisk_write_disklabel(cxt) == 0;
+    LibfdiskBackend::closeContext(cxt);
+
+    if (!rval)
+        report.line() << xi18nc("@info:progress", "Could not create a new partition table of type %1 on device <filename>%2</filename>.", ptable.typeName(), m_device->deviceNode());
+
+    return rval;
+}
@@ -0,0 +1,41 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef LIBFDISKDEVICE__H
+#define LIBFDISKDEVICE__H
+
+#include "backend/corebackenddevice.h"
+#include "core/device.h"
+
+#include <QtGlobal>
+
+class Partition;
+class PartitionTable;
+class Report;
+class CoreBackendPartitionTable;
+
+class LibfdiskDevice : public CoreBackendDevice
+{
+    Q_DISABLE_COPY(LibfdiskDevice)
+
+public:
+    explicit LibfdiskDevice(const Device& d);
+    ~LibfdiskDevice();
+
+public:
+    bool open() override;
+    bool openExclusive() override;
+    bool close() override;
+
+    std::unique_ptr<CoreBackendPartitionTable> openPartitionTable() override;
+
+    bool createPartitionTable(Report& report, const PartitionTable& ptable) override;
+
+private:
+    const Device *m_device;
+};
+
+#endif
@@ -0,0 +1,466 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "plugins/libfdisk/libfdiskpartitiontable.h"
+#include "plugins/libfdisk/libfdiskbackend.h"
+#include "plugins/partitiontypes.h"
+
+#include "backend/commitbatch.h"
+#include "backend/corebackend.h"
+#include "backend/corebackendmanager.h"
+
+#include "core/partition.h"
+#include "core/device.h"
+
+#include "fs/filesystem.h"
+
+#include "util/report.h"
+
+#include <QDeadlineTimer>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QThread>
+
+#include <KLocalizedString>
+
+#include <blkid/blkid.h>
+#include <libfdisk/libfdisk.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+LibfdiskPartitionTable::LibfdiskPartitionTable(const Device* d) :
+    CoreBackendPartitionTable(),
+    m_device(d),
+    m_Context(nullptr),
+    m_MenuAnswer('p')
+{
+}
+
+LibfdiskPartitionTable::~LibfdiskPartitionTable()
+{
+    LibfdiskBackend::closeContext(m_Context);
+}
+
+bool LibfdiskPartitionTable::open()
+{
+    return true;
+}
+
+/* libfdisk asks its caller whenever it cannot decide something on its own. New MBR
+ * partitions get the kind the partition table chose, everything else the default.
+ */
+static int answer(fdisk_context*, fdisk_ask* ask, void* data)
+{
+    switch (fdisk_ask_get_type(ask)) {
+    case FDISK_ASKTYPE_MENU:
+        return fdisk_ask_menu_set_result(ask, *static_cast<const int*>(data));
+    case FDISK_ASKTYPE_NUMBER:
+        return fdisk_ask_number_set_result(ask, fdisk_ask_number_get_default(ask));
+    case FDISK_ASKTYPE_WARN:
+    case FDISK_ASKTYPE_WARNX:
+        qWarning() << "libfdisk:" << fdisk_ask_print_get_mesg(ask);
+        return 0;
+    default:
+        return 0;
+    }
+}
+
+/** @return the context changes are made in, opened on first use */
+fdisk_context* LibfdiskPartitionTable::context(Report& report)
+{
+    if (m_Context)
+        return m_Context;
+
+    m_Context = LibfdiskBackend::openContext(m_device->deviceNode(), false);
+    if (m_Context)
+        fdisk_set_ask(m_Context, answer, &m_MenuAnswer);
+    else
+        report.line() << xi18nc("@info:progress", "Could not open device <filename>%1</filename> to change its partition table.", m_device->deviceNode());
+
+    return m_Context;
+}
+
+bool LibfdiskPartitionTable::write(Report& report)
+{
+    if (fdisk_write_disklabel(m_Context) == 0)
+        return true;
+
+    report.line() << xi18nc("@info:progress", "Could not write the partition table of device <filename>%1</filename>.", m_device->deviceNode());
+    return false;
+}
+
+/** @return the names of the partitions of a disk in sysfs */
+static QStringList kernelPartitions(const QString& sysfsDir)
+{
+    QStringList partitions;
+    const QStringList entries = QDir(sysfsDir).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& entry : entries)
+        if (QFileInfo::exists(sysfsDir + entry + QStringLiteral("/partition")))
+            partitions.append(entry);
+
+    return partitions;
+}
+
+/* Tells the kernel about the partitions on a device with BLKPG, libfdisk only changes
+ * what differs from the partitions the kernel knows of in sysfs. udev is told with a
+ * change uevent for the disk and its partitions, which is waited for until udev added
+ * all partitions to its database.
+ */
+static bool syncKernel(Report& report, const QString& deviceNode, quint32 timeout)
+{
+    const QString kernelName = QFileInfo(deviceNode).canonicalFilePath().section(QLatin1Char('/'), -1);
+    const QString sysfsDir = QStringLiteral("/sys/class/block/") + kernelName + QLatin1Char('/');
+
+    fdisk_context* cxt = LibfdiskBackend::openContext(deviceNode, false);
+    if (kernelName.isEmpty() || !cxt) {
+        LibfdiskBackend::closeContext(cxt);
+        report.line() << xi18nc("@info:progress", "Could not update the partitions of device <filename>%1</filename> in the kernel.", deviceNode);
+        return false;
+    }
+
+    // sysfs counts in 512 byte sectors regardless of the device
+    const qint64 sectorSize = fdisk_get_sector_size(cxt);
+    fdisk_table* known = fdisk_new_table();
+    for (const QString& name : kernelPartitions(sysfsDir)) {
+        const QString partitionDir = sysfsDir + name + QLatin1Char('/');
+        const size_t partno = LibfdiskBackend::readAttribute(partitionDir + QStringLiteral("partition")).toULongLong() - 1;
+        const qint64 start = LibfdiskBackend::readAttribute(partitionDir + QStringLiteral("start")).toLongLong() * 512 / sectorSize;
+        qint64 size = LibfdiskBackend::readAttribute(partitionDir + QStringLiteral("size")).toLongLong() * 512 / sectorSize;
+
+        // The kernel only maps the first sector(s) of an extended partition
+        fdisk_partition* current = nullptr;
+        if (fdisk_get_partition(cxt, partno, &current) == 0) {
+            if (fdisk_partition_is_container(current) == 1 && fdisk_partition_get_start(current) == static_cast<fdisk_sector_t>(start))
+                size = fdisk_partition_get_size(current);
+            fdisk_unref_partition(current);
+        }
+
+        fdisk_partition* pa = fdisk_new_partition();
+        fdisk_partition_set_partno(pa, partno);
+        fdisk_partition_set_start(pa, start);
+        fdisk_partition_set_size(pa, size);
+        fdisk_table_add_partition(known, pa);
+        fdisk_unref_partition(pa);
+    }
+
+    // Rereading the whole table only works if no partition is in use
+    bool rval = fdisk_reread_changes(cxt, known) == 0 || fdisk_reread_partition_table(cxt) == 0;
+    fdisk_unref_table(known);
+    LibfdiskBackend::closeContext(cxt);
+
+    if (!rval)
+        report.line() << xi18nc("@info:progress", "Could not update the partitions of device <filename>%1</filename> in the kernel.", deviceNode);
+
+    const QStringList partitions = kernelPartitions(sysfsDir);
+    QStringList ueventFiles = { sysfsDir + QStringLiteral("uevent") };
+    for (const QString& name : partitions)
+        ueventFiles.append(sysfsDir + name + QStringLiteral("/uevent"));
+
+    for (const QString& fileName : std::as_const(ueventFiles)) {
+        QFile uevent(fileName);
+        if (uevent.open(QIODevice::WriteOnly))
+            uevent.write("change");
+    }
+
+    // udev has a database entry for every block device it processed
+    const QString udevData = QStringLiteral("/run/udev/data/b");
+    if (!QFileInfo::exists(QStringLiteral("/run/udev/data")))
+        return rval;
+
+    QDeadlineTimer deadline(timeout * 1000);
+    for (const QString& name : partitions) {
+        const QString dataFile = udevData + QString::fromLatin1(LibfdiskBackend::readAttribute(sysfsDir + name + QStringLiteral("/dev")));
+        while (!QFileInfo::exists(dataFile) && !deadline.hasExpired())
+            QThread::msleep(50);
+    }
+
+    return rval;
+}
+
+/* Changes are already written, this only tells the kernel and udev. Within a
+ * CommitBatch that is done once per device when the batch is flushed.
+ */
+bool LibfdiskPartitionTable::commit(quint32 timeout)
+{
+    // Flush the changes before the kernel reads the device
+    LibfdiskBackend::closeContext(m_Context);
+    m_Context = nullptr;
+
+    const QString deviceNode = m_device->deviceNode();
+    auto sync = [deviceNode, timeout] (Report& report) {
+        return syncKernel(report, deviceNode, timeout);
+    };
+
+    if (CommitBatch::defer(deviceNode, sync))
+        return true;
+
+    Report report(nullptr);
+    return sync(report);
+}
+
+QString LibfdiskPartitionTable::createPartition(Report& report, const Partition& partition)
+{
+    if ( !(partition.roles().has(PartitionRole::Extended) || partition.roles().has(PartitionRole::Logical) || partition.roles().has(PartitionRole::Primary) ) ) {
+        report.line() << xi18nc("@info:progress", "Unknown partition role for new partition <filename>%1</filename> (roles: %2)", partition.deviceNode(), partition.roles().toString());
+        return QString();
+    }
+
+    fdisk_context* cxt = context(report);
+    if (!cxt)
+        return QString();
+
+    if (partition.roles().has(PartitionRole::Extended))
+        m_MenuAnswer = 'e';
+    else if (partition.roles().has(PartitionRole::Logical))
+        m_MenuAnswer = 'l';
+    else
+        m_MenuAnswer = 'p';
+
+    fdisk_partition* pa = fdisk_new_partition();
+    fdisk_partition_set_start(pa, partition.firstSector());
+    fdisk_partition_set_size(pa, partition.length());
+    fdisk_partition_partno_follow_default(pa, 1);
+
+    size_t partno = 0;
+    const bool added = fdisk_add_partition(cxt, pa, &partno) == 0 && write(report);
+    fdisk_unref_partition(pa);
+
+    if (added)
+        return LibfdiskBackend::partitionNode(partition.devicePath(), partno + 1);
+
+    report.line() << xi18nc("@info:progress", "Failed to add partition <filename>%1</filename> to device <filename>%2</filename>.", partition.deviceNode(), m_device->deviceNode());
+
+    return QString();
+}
+
+bool LibfdiskPartitionTable::deletePartition(Report& report, const Partition& partition)
+{
+    fdisk_context* cxt = context(report);
+    if (cxt && fdisk_delete_partition(cxt, partition.number() - 1) == 0 && write(report))
+        return true;
+
+    report.line() << xi18nc("@info:progress", "Could not delete partition <filename>%1</filename>.", partition.devicePath());
+    return false;
+}
+
+bool LibfdiskPartitionTable::updateGeometry(Report& report, const Partition& partition, qint64 sectorStart, qint64 sectorEnd)
+{
+    fdisk_context* cxt = context(report);
+    if (cxt) {
+        fdisk_partition* pa = fdisk_new_partition();
+        fdisk_partition_set_start(pa, sectorStart);
+        fdisk_partition_set_size(pa, sectorEnd - sectorStart + 1);
+        const bool rval = fdisk_set_partition(cxt, partition.number() - 1, pa) == 0 && write(report);
+        fdisk_unref_partition(pa);
+
+        if (rval)
+            return true;
+    }
+
+    report.line() << xi18nc("@info:progress", "Could not set geometry for partition <filename>%1</filename> while trying to resize/move it.", partition.devicePath());
+    return false;
+}
+
+/* Erases all signatures libblkid finds, like wipefs --all */
+bool LibfdiskPartitionTable::clobberFileSystem(Report& report, const Partition& partition)
+{
+    bool rval = false;
+
+    const int fd = ::open(QFile::encodeName(partition.partitionPath()).constData(), O_RDWR | O_CLOEXEC);
+    if (fd >= 0) {
+        if (blkid_probe pr = blkid_new_probe()) {
+            if (blkid_probe_set_device(pr, fd, 0, 0) == 0) {
+                blkid_probe_enable_superblocks(pr, 1);
+                blkid_probe_set_superblocks_flags(pr, BLKID_SUBLKS_MAGIC);
+                blkid_probe_enable_partitions(pr, 1);
+                blkid_probe_set_partitions_flags(pr, BLKID_PARTS_MAGIC);
+
+                rval = true;
+                while (rval && blkid_do_probe(pr) == 0)
+                    rval = blkid_do_wipe(pr, 0) == 0;
+            }
+            blkid_free_probe(pr);
+        }
+
+        rval = fsync(fd) == 0 && rval;
+        close(fd);
+    }
+
+    if (!rval)
+        report.line() << xi18nc("@info:progress", "Failed to erase filesystem signature on partition <filename>%1</filename>.", partition.partitionPath());
+
+    return rval;
+}
+
+bool LibfdiskPartitionTable::resizeFileSystem(Report& report, const Partition& partition, qint64 newLength)
+{
+    // libfdisk does not have any partition resize capabilities
+    Q_UNUSED(report)
+    Q_UNUSED(partition)
+    Q_UNUSED(newLength)
+
+    return false;
+}
+
+FileSystem::Type LibfdiskPartitionTable::detectFileSystemBySector(Report& report, const Device& device, qint64 sector)
+{
+    QString partitionNode;
+
+    if (fdisk_context* cxt = LibfdiskBackend::openContext(device.deviceNode(), true)) {
+        fdisk_table* table = nullptr;
+        if (fdisk_get_partitions(cxt, &table) == 0) {
+            fdisk_iter* itr = fdisk_new_iter(FDISK_ITER_FORWARD);
+            fdisk_partition* pa = nullptr;
+
+            while (partitionNode.isEmpty() && fdisk_table_next_partition(table, itr, &pa) == 0)
+                if (fdisk_partition_has_start(pa) && fdisk_partition_get_start(pa) == static_cast<fdisk_sector_t>(sector))
+                    partitionNode = LibfdiskBackend::partitionNode(device.deviceNode(), fdisk_partition_get_partno(pa) + 1);
+
+            fdisk_free_iter(itr);
+            fdisk_unref_table(table);
+        }
+        LibfdiskBackend::closeContext(cxt);
+    }
+
+    if (!partitionNode.isEmpty())
+        return CoreBackendManager::self()->backend()->detectFileSystem(partitionNode);
+
+    report.line() << xi18nc("@info:progress", "Could not determine file system of partition at sector %1 on device <filename>%2</filename>.", sector, device.deviceNode());
+
+    return FileSystem::Type::Unknown;
+}
+
+/** Set the type of a partition.
+    @param partitionType a GUID on GPT, a hexadecimal code on MBR
+*/
+bool LibfdiskPartitionTable::setType(Report& report, const Partition& partition, const QString& partitionType)
+{
+    fdisk_context* cxt = context(report);
+    if (!cxt)
+        return false;
+
+    fdisk_parttype* type = fdisk_label_parse_parttype(fdisk_get_label(cxt, nullptr), partitionType.toLatin1().constData());
+    if (!type) {
+        report.line() << xi18nc("@info:progress", "Unknown partition type %1 for partition <filename>%2</filename>.", partitionType, partition.devicePath());
+        return false;
+    }
+
+    const bool rval = fdisk_set_partition_type(cxt, partition.number() - 1, type) == 0 && write(report);
+    fdisk_unref_parttype(type);
+    return rval;
+}
+
+bool LibfdiskPartitionTable::setPartitionLabel(Report& report, const Partition& partition, const QString& label)
+{
+    if (label.isEmpty())
+        return true;
+
+    fdisk_context* cxt = context(report);
+    if (!cxt)
+        return false;
+
+    fdisk_partition* pa = fdisk_new_partition();
+    fdisk_partition_set_name(pa, label.toUtf8().constData());
+    const bool rval = fdisk_set_partition(cxt, partition.number() - 1, pa) == 0 && write(report);
+    fdisk_unref_partition(pa);
+    return rval;
+}
+
+QString LibfdiskPartitionTable::getPartitionUUID(Report& report, const Partition& partition)
+{
+    QString uuid;
+
+    fdisk_context* cxt = context(report);
+    fdisk_partition* pa = nullptr;
+    if (cxt && fdisk_get_partition(cxt, partition.number() - 1, &pa) == 0) {
+        uuid = QString::fromLatin1(fdisk_partition_get_uuid(pa));
+        fdisk_unref_partition(pa);
+    }
+
+    return uuid;
+}
+
+bool LibfdiskPartitionTable::setPartitionUUID(Report& report, const Partition& partition, const QString& uuid)
+{
+    if (uuid.isEmpty())
+        return true;
+
+    fdisk_context* cxt = context(report);
+    if (!cxt)
+        return false;
+
+    fdisk_partition* pa = fdisk_new_partition();
+    fdisk_partition_set_uuid(pa, uuid.toLatin1().constData());
+    const bool rval = fdisk_set_partition(cxt, partition.number() - 1, pa) == 0 && write(report);
+    fdisk_unref_partition(pa);
+    return rval;
+}
+
+bool LibfdiskPartitionTable::setPartitionAttributes(Report& report, const Partition& partition, quint64 attrs)
+{
+    // Only GPT has attributes
+    if (m_device->partitionTable()->type() != PartitionTable::TableType::gpt)
+        return attrs == 0;
+
+    fdisk_context* cxt = context(report);
+    return cxt && fdisk_gpt_set_partition_attrs(cxt, partition.number() - 1, attrs) == 0 && write(report);
+}
+
+bool LibfdiskPartitionTable::setPartitionSystemType(Report& report, const Partition& partition)
+{
+    QString partitionType = partition.type();
+    if (partitionType.isEmpty())
+        partitionType = PartitionTypes::forFileSystem(partition.fileSystem().type(), m_device->partitionTable()->type());
+    if (partitionType.isEmpty())
+        return true;
+
+    return setType(report, partition, partitionType);
+}
+
+bool LibfdiskPartitionTable::setFlag(Report& report, const Partition& partition, PartitionTable::Flag flag, bool state)
+{
+    if (m_device->partitionTable()->type() == PartitionTable::TableType::msdos) {
+        if (flag != PartitionTable::Flag::Boot)
+            return true;
+
+        fdisk_context* cxt = context(report);
+        if (!cxt)
+            return false;
+
+        // We only allow setting one active partition per device
+        const size_t active = partition.number() - 1;
+        for (size_t i = 0; i < fdisk_get_npartitions(cxt); ++i) {
+            if (!fdisk_is_partition_used(cxt, i))
+                continue;
+
+            fdisk_partition* pa = nullptr;
+            if (fdisk_get_partition(cxt, i, &pa) != 0)
+                return false;
+            const bool bootable = fdisk_partition_is_bootable(pa) == 1;
+            fdisk_unref_partition(pa);
+
+            if (bootable != (state && i == active) && fdisk_toggle_partition_flag(cxt, i, DOS_FLAG_ACTIVE) != 0)
+                return false;
+        }
+
+        return write(report);
+    }
+
+    if (flag == PartitionTable::Flag::Boot && state == true)
+        return setType(report, partition, QStringLiteral("C12A7328-F81F-11D2-BA4B-00A0C93EC93B"));
+    if (flag == PartitionTable::Flag::Boot && state == false)
+        setPartitionSystemType(report, partition);
+
+    if (flag == PartitionTable::Flag::BiosGrub && state == true)
+        return setType(report, partition, QStringLiteral("21686148-6449-6E6F-744E-656564454649"));
+    if (flag == PartitionTable::Flag::BiosGrub && state == false)
+        setPartitionSystemType(report, partition);
+
+    return true;
+}
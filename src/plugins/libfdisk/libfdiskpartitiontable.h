@@ -0,0 +1,63 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef LIBFDISKPARTITIONTABLE__H
+#define LIBFDISKPARTITIONTABLE__H
+
+#include "backend/corebackendpartitiontable.h"
+
+#include "fs/filesystem.h"
+
+#include <QtGlobal>
+
+class CoreBackendPartition;
+class Report;
+class Partition;
+
+struct fdisk_context;
+
+/** Partition table of a device edited with libfdisk.
+
+    The device is opened on the first change and every change is written to it
+    right away. commit() tells the kernel about the changed partitions with BLKPG
+    ioctls and udev with uevents, once per device within a CommitBatch.
+*/
+class LibfdiskPartitionTable : public CoreBackendPartitionTable
+{
+public:
+    explicit LibfdiskPartitionTable(const Device *d);
+    ~LibfdiskPartitionTable();
+
+public:
+    bool open() override;
+
+    bool commit(quint32 timeout = 10) override;
+
+    QString createPartition(Report& report, const Partition& partition) override;
+    bool deletePartition(Report& report, const Partition& partition) override;
+    bool updateGeometry(Report& report, const Partition& partition, qint64 sector_start, qint64 sector_end) override;
+    bool clobberFileSystem(Report& report, const Partition& partition) override;
+    bool resizeFileSystem(Report& report, const Partition& partition, qint64 newLength) override;
+    FileSystem::Type detectFileSystemBySector(Report& report, const Device& device, qint64 sector) override;
+    bool setPartitionLabel(Report& report, const Partition& partition, const QString& label) override;
+    QString getPartitionUUID(Report& report, const Partition& partition) override;
+    bool setPartitionUUID(Report& report, const Partition& partition, const QString& uuid) override;
+    bool setPartitionAttributes(Report& report, const Partition& partition, quint64 attrs) override;
+    bool setPartitionSystemType(Report& report, const Partition& partition) override;
+    bool setFlag(Report& report, const Partition& partition, PartitionTable::Flag flag, bool state) override;
+
+private:
+    fdisk_context* context(Report& report);
+    bool write(Report& report);
+    bool setType(Report& report, const Partition& partition, const QString& partitionType);
+
+private:
+    const Device *m_device;
+    fdisk_context* m_Context;
+    int m_MenuAnswer;   /**< answer to libfdisk asking for the kind of a new MBR partition */
+};
+
+#endif
@@ -0,0 +1,28 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_PARTITIONTYPES_H
+#define KPMCORE_PARTITIONTYPES_H
+
+#include "core/partitiontable.h"
+
+#include "fs/filesystem.h"
+
+#include <QLatin1String>
+
+/** Partition types of file systems as sfdisk and libfdisk write them.
+
+    Shared by the sfdisk and libfdisk backend plugins.
+
+    @author kpmcore contributors
+*/
+class PartitionTypes
+{
+public:
+    static QLatin1String forFileSystem(FileSystem::Type t, PartitionTable::TableType tableType);
+};
+
+#endif
@@ -19,9 +19,13 @@
 #include "core/copytargetbytearray.h"
 #include "core/diskdevice.h"
 #include "core/lvmdevice.h"
+#include "core/lvmreport.h"
+#include "core/mountindex.h"
 #include "core/partitiontable.h"
 #include "core/partitionalignment.h"
 #include "core/raid/softwareraid.h"
+#include "core/scancache.h"
+#include "core/usedspacereader.h"
 
 #include "fs/filesystemfactory.h"
 #include "fs/luks.h"
@@ -30,6 +34,7 @@
 #include "util/globallog.h"
 #include "util/externalcommand.h"
 #include "util/helpers.h"
+#include "util/lvmshell.h"
 
 #include <utility>
 
@@ -54,6 +59,10 @@ SfdiskBackend::SfdiskBackend(QObject*, const QList<QVariant>&) :
 {
 }
 
+SfdiskBackend::~SfdiskBackend()
+{
+}
+
 void SfdiskBackend::initFSSupport()
 {
 }
@@ -62,6 +71,19 @@ QList<Device*> SfdiskBackend::scanDevices(const ScanFlags scanFlags)
 {
     const bool includeReadOnly = scanFlags.testFlag(ScanFlag::includeReadOnly);
     const bool includeLoopback = scanFlags.testFlag(ScanFlag::includeLoopback);
+    const bool useScanCache = scanFlags.testFlag(ScanFlag::useScanCache) && !m_ScanCache;
+
+    if (useScanCache)
+        m_ScanCache = std::make_unique<ScanCache>();
+
+    // Read the mount table and fstab once for all partitions found during this scan
+    const MountIndex mountIndex;
+
+    // Query LVM once for the PVs found on disks and the VGs scanned afterwards
+    const LvmReport lvmReport;
+
+    // LVs are activated with one lvm process
+    const LvmShell lvmShell;
 
     QList<Device*> result;
     QStringList deviceNodes;
@@ -113,6 +135,11 @@ QList<Device*> SfdiskBackend::scanDevices(const ScanFlags scanFlags)
 
     VolumeManagerDevice::scanDevices(result); // scan all types of VolumeManagerDevices
 
+    if (useScanCache) {
+        m_ScanCache->save();
+        m_ScanCache.reset();
+    }
+
     return result;
 }
 
@@ -170,8 +197,8 @@ QList<Device*> SfdiskBackend::scanDevices(const ScanFlags scanFlags)
  *        },{
  * etc.
  */
-static void
-fixInvalidJsonFromSFDisk( QByteArray& s )
+void
+SfdiskBackend::fixInvalidJsonFromSFDisk( QByteArray& s )
 {
     int jsonStart = s.indexOf('{');
     if (jsonStart != 0) {
@@ -206,6 +233,14 @@ fixInvalidJsonFromSFDisk( QByteArray& s )
 */
 Device* SfdiskBackend::scanDevice(const QString& deviceNode)
 {
+    m_PartitionProbes = QJsonObject();
+
+    if (m_ScanCache) {
+        const QJsonObject record = m_ScanCache->lookup(deviceNode);
+        if (!record.isEmpty())
+            return scanCachedDevice(deviceNode, record);
+    }
+
     ExternalCommand modelCommand(QStringLiteral("lsblk"),
                         { QStringLiteral("--nodeps"),
                           QStringLiteral("--noheadings"),
@@ -277,32 +312,22 @@ Device* SfdiskBackend::scanDevice(const QString& deviceNode)
 
         if ( d )
         {
-            if (sfdiskJsonCommand.exitCode() != 0) {
-                scanWholeDevicePartition(*d);
-                return d;
-            }
-
-            auto s = sfdiskJsonCommand.rawOutput();
-            fixInvalidJsonFromSFDisk(s);
-
-            const QJsonObject jsonObject = QJsonDocument::fromJson(s).object();
-            const QJsonObject partitionTable = jsonObject[QLatin1String("partitiontable")].toObject();
-
-            if (jsonObject.isEmpty()) {
-                qDebug() << "json object created from sfdisk output is empty !\nOutput is \"" << s.data() << "\"";
-            }
+            if (!scanPartitionTable(*d, sfdiskJsonCommand.exitCode(), sfdiskJsonCommand.rawOutput()))
+                return nullptr;
 
-            /* Workaround for whole device FAT partitions */
-            if(partitionTable[QLatin1String("label")].toString() == QStringLiteral("dos")) {
-                scanWholeDevicePartition(*d);
-                if(d->partitionTable()) {
-                    return d;
-                }
+            // Software RAID devices are not cached, their members are looked up on every scan anyway
+            if (m_ScanCache && d->type() == Device::Type::Disk_Device) {
+                QJsonObject record;
+                record[QLatin1String("name")] = d->name();
+                record[QLatin1String("icon")] = d->iconName();
+                record[QLatin1String("sectorSize")] = d->logicalSize();
+                record[QLatin1String("sectors")] = d->totalLogical();
+                record[QLatin1String("sfdiskExitCode")] = sfdiskJsonCommand.exitCode();
+                record[QLatin1String("sfdiskOutput")] = QString::fromUtf8(sfdiskJsonCommand.rawOutput());
+                record[QLatin1String("partitions")] = m_PartitionProbes;
+                m_ScanCache->insert(deviceNode, record);
             }
 
-            if (!updateDevicePartitionTable(*d, partitionTable))
-                return nullptr;
-
             return d;
         }
     }
@@ -323,6 +348,78 @@ Device* SfdiskBackend::scanDevice(const QString& deviceNode)
     return nullptr;
 }
 
+/** Create a Device from the results of a previous scan.
+
+    The partition table and everything that was probed for the partitions is taken from
+    the cache, only mount points and LUKS mappings are detected again.
+
+    @param deviceNode the device node (e.g. "/dev/sda")
+    @param record the record stored in the ScanCache for this device
+    @return the created Device object. callers need to free this.
+*/
+Device* SfdiskBackend::scanCachedDevice(const QString& deviceNode, const QJsonObject& record)
+{
+    const qint64 logicalSectorSize = record[QLatin1String("sectorSize")].toInteger();
+    const qint64 sectors = record[QLatin1String("sectors")].toInteger();
+    if (logicalSectorSize <= 0 || sectors <= 0)
+        return nullptr;
+
+    const QString name = record[QLatin1String("name")].toString();
+    Log(Log::Level::information) << xi18nc("@info:status", "Device found: %1", name);
+
+    Device* d = new DiskDevice(name, deviceNode, logicalSectorSize, sectors, record[QLatin1String("icon")].toString());
+
+    const QJsonObject cachedProbes = record[QLatin1String("partitions")].toObject();
+    m_PartitionProbes = cachedProbes;
+    if (!scanPartitionTable(*d, record[QLatin1String("sfdiskExitCode")].toInt(),
+                            record[QLatin1String("sfdiskOutput")].toString().toUtf8())) {
+        delete d;
+        return nullptr;
+    }
+
+    // Keep values that had to be probed now, e.g. the label of a file system that was unknown before
+    if (m_PartitionProbes != cachedProbes) {
+        QJsonObject updatedRecord = record;
+        updatedRecord[QLatin1String("partitions")] = m_PartitionProbes;
+        m_ScanCache->insert(deviceNode, updatedRecord);
+    }
+
+    return d;
+}
+
+/** Creates the PartitionTable of a Device from the output of sfdisk --json.
+    @param d the Device to scan
+    @param sfdiskExitCode exit code of sfdisk, non-zero if the device has no partition table
+    @param sfdiskOutput the JSON output of sfdisk
+    @return false if the partition table could not be set up
+*/
+bool SfdiskBackend::scanPartitionTable(Device& d, int sfdiskExitCode, QByteArray sfdiskOutput)
+{
+    if (sfdiskExitCode != 0) {
+        scanWholeDevicePartition(d);
+        return true;
+    }
+
+    fixInvalidJsonFromSFDisk(sfdiskOutput);
+
+    const QJsonObject jsonObject = QJsonDocument::fromJson(sfdiskOutput).object();
+    const QJsonObject partitionTable = jsonObject[QLatin1String("partitiontable")].toObject();
+
+    if (jsonObject.isEmpty()) {
+        qDebug() << "json object created from sfdisk output is empty !\nOutput is \"" << sfdiskOutput.data() << "\"";
+    }
+
+    /* Workaround for whole device FAT partitions */
+    if(partitionTable[QLatin1String("label")].toString() == QStringLiteral("dos")) {
+        scanWholeDevicePartition(d);
+        if(d.partitionTable()) {
+            return true;
+        }
+    }
+
+    return updateDevicePartitionTable(d, partitionTable);
+}
+
 /** Scans a Device for FileSystems spanning the whole block device
 
     This method  will scan a Device for a FileSystem.
@@ -387,7 +484,15 @@ Partition* SfdiskBackend::scanPartition(Device& d, const QString& partitionNode,
     else if (partitionType == QStringLiteral("21686148-6449-6E6F-744E-656564454649"))
         activeFlags |= PartitionTable::Flag::BiosGrub;
 
-    FileSystem::Type type = detectFileSystem(partitionNode);
+    FileSystem::Type type;
+    const QJsonValue cachedType = cachedProbe(partitionNode, QStringLiteral("type"));
+    if (cachedType.isDouble())
+        type = static_cast<FileSystem::Type>(cachedType.toInt());
+    else {
+        type = detectFileSystem(partitionNode);
+        storeProbe(partitionNode, QStringLiteral("type"), static_cast<int>(type));
+    }
+
     PartitionRole::Roles r = PartitionRole::Primary;
 
     if ( (d.partitionTable()->type() == PartitionTable::msdos) &&
@@ -425,11 +530,25 @@ Partition* SfdiskBackend::scanPartition(Device& d, const QString& partitionNode,
 
     Partition* partition = new Partition(parent, d, PartitionRole(r), fs, firstSector, lastSector, partitionNode, availableFlags(d.partitionTable()->type()), mountPoint, mounted, activeFlags);
 
-    if (fs->supportGetLabel() != FileSystem::cmdSupportNone)
-        fs->setLabel(fs->readLabel(partition->deviceNode()));
+    if (fs->supportGetLabel() != FileSystem::cmdSupportNone) {
+        const QJsonValue cachedLabel = cachedProbe(partitionNode, QStringLiteral("label"));
+        if (cachedLabel.isString())
+            fs->setLabel(cachedLabel.toString());
+        else {
+            fs->setLabel(fs->readLabel(partition->deviceNode()));
+            storeProbe(partitionNode, QStringLiteral("label"), fs->label());
+        }
+    }
 
-    if (fs->supportGetUUID() != FileSystem::cmdSupportNone)
-        fs->setUUID(fs->readUUID(partition->deviceNode()));
+    if (fs->supportGetUUID() != FileSystem::cmdSupportNone) {
+        const QJsonValue cachedUUID = cachedProbe(partitionNode, QStringLiteral("uuid"));
+        if (cachedUUID.isString())
+            fs->setUUID(cachedUUID.toString());
+        else {
+            fs->setUUID(fs->readUUID(partition->deviceNode()));
+            storeProbe(partitionNode, QStringLiteral("uuid"), fs->uuid());
+        }
+    }
 
     parent->append(partition);
     return partition;
@@ -522,8 +641,31 @@ void SfdiskBackend::readSectorsUsed(const Device& d, Partition& p, const QString
         if (p.isMounted() && storage.isValid())
             p.fileSystem().setSectorsUsed( (storage.bytesTotal() - storage.bytesFree()) / d.logicalSize());
     }
-    else if (p.fileSystem().supportGetUsed() == FileSystem::cmdSupportFileSystem)
-        p.fileSystem().setSectorsUsed(p.fileSystem().readUsedCapacity(p.deviceNode()) / d.logicalSize());
+    else if (p.fileSystem().supportGetUsed() == FileSystem::cmdSupportFileSystem) {
+        // Not taken from the ScanCache: mounting and writing to a file system changes
+        // nothing the cache's generation covers.
+        if (UsedSpaceReader* reader = UsedSpaceReader::current())
+            reader->enqueue(p);
+        else
+            p.fileSystem().setSectorsUsed(p.fileSystem().readUsedCapacity(p.deviceNode()) / d.logicalSize());
+    }
+}
+
+/** @return a value probed for a partition during a previous scan or an undefined value */
+QJsonValue SfdiskBackend::cachedProbe(const QString& partitionNode, const QString& key) const
+{
+    return m_PartitionProbes[partitionNode].toObject()[key];
+}
+
+/** Remember a value probed for a partition so it can be stored in the ScanCache. */
+void SfdiskBackend::storeProbe(const QString& partitionNode, const QString& key, const QJsonValue& value)
+{
+    if (!m_ScanCache)
+        return;
+
+    QJsonObject probes = m_PartitionProbes[partitionNode].toObject();
+    probes[key] = value;
+    m_PartitionProbes[partitionNode] = probes;
 }
 
 FileSystem::Type SfdiskBackend::detectFileSystem(const QString& partitionPath)
@@ -12,12 +12,16 @@
 #include "core/partition.h"
 #include "fs/filesystem.h"
 
+#include <memory>
+
+#include <QJsonObject>
 #include <QList>
 #include <QVariant>
 
 class Device;
 class ExternalCommand;
 class Partition;
+class ScanCache;
 class KPluginFactory;
 class QString;
 
@@ -31,6 +35,7 @@ class SfdiskBackend : public CoreBackend
 
 public:
     SfdiskBackend(QObject* parent, const QList<QVariant>& args);
+    ~SfdiskBackend() override;
 
 public:
     void initFSSupport() override;
@@ -44,16 +49,26 @@ public:
     QString readLabel(const QString& deviceNode) const override;
     QString readUUID(const QString& deviceNode) const override;
 
+    static void fixInvalidJsonFromSFDisk(QByteArray& s);
+
 private:
-    static void readSectorsUsed(const Device& d, Partition& p, const QString& mountPoint);
+    void readSectorsUsed(const Device& d, Partition& p, const QString& mountPoint);
+    Device* scanCachedDevice(const QString& deviceNode, const QJsonObject& record);
+    bool scanPartitionTable(Device& d, int sfdiskExitCode, QByteArray sfdiskOutput);
     void scanDevicePartitions(Device& d, const QJsonArray& jsonPartitions);
     Partition* scanPartition(Device& d, const QString& partitionNode, const qint64 firstSector, const qint64 lastSector, const QString& partitionType, const bool bootable);
     void scanWholeDevicePartition(Device& d);
-    static void setupPartitionInfo(const Device& d, Partition* partition, const QJsonObject& partitionObject);
+    void setupPartitionInfo(const Device& d, Partition* partition, const QJsonObject& partitionObject);
+    QJsonValue cachedProbe(const QString& partitionNode, const QString& key) const;
+    void storeProbe(const QString& partitionNode, const QString& key, const QJsonValue& value);
     bool updateDevicePartitionTable(Device& d, const QJsonObject& jsonPartitionTable);
     static PartitionTable::Flags availableFlags(PartitionTable::TableType type);
     static FileSystem::Type fileSystemNameToType(const QString& fileSystemName, const QString& version);
     static FileSystem::Type runDetectFileSystemCommand(ExternalCommand& command, QString& typeRegExp, QString& versionRegExp, QString& name);
+
+private:
+    std::unique_ptr<ScanCache> m_ScanCache; /**< only set while scanDevices() runs with ScanFlag::useScanCache */
+    QJsonObject m_PartitionProbes; /**< probe results of the device being scanned, keyed by partition node */
 };
 
 #endif
@@ -7,8 +7,11 @@
 */
 
 #include "plugins/sfdisk/sfdiskpartitiontable.h"
+#include "plugins/sfdisk/sfdiskbackend.h"
 #include "plugins/sfdisk/sfdiskgptattributes.h"
+#include "plugins/partitiontypes.h"
 
+#include "backend/commitbatch.h"
 #include "backend/corebackend.h"
 #include "backend/corebackendmanager.h"
 
@@ -28,6 +31,8 @@
 
 #include <KLocalizedString>
 
+#include <algorithm>
+
 SfdiskPartitionTable::SfdiskPartitionTable(const Device* d) :
     CoreBackendPartitionTable(),
     m_device(d)
@@ -43,20 +48,94 @@ bool SfdiskPartitionTable::open()
     return true;
 }
 
-bool SfdiskPartitionTable::commit(quint32 timeout)
+/* Tells the kernel about the partitions sfdisk reports for a disk and waits for udev
+ * to process them, see ExternalCommandHelper::UpdatePartitions().
+ */
+static bool updateKernelPartitions(const QString& deviceNode, qint64 sectorSize, quint32 timeout)
+{
+    ExternalCommand jsonCommand(QStringLiteral("sfdisk"), { QStringLiteral("--json"), deviceNode }, QProcess::ProcessChannelMode::SeparateChannels);
+    if (!jsonCommand.run(-1) || jsonCommand.exitCode() != 0)
+        return false;
+
+    QByteArray output = jsonCommand.rawOutput();
+    SfdiskBackend::fixInvalidJsonFromSFDisk(output);
+
+    const QJsonObject table = QJsonDocument::fromJson(output).object()[QLatin1String("partitiontable")].toObject();
+    if (table.isEmpty())
+        return false;
+    if (table.contains(QLatin1String("sectorsize")))
+        sectorSize = table[QLatin1String("sectorsize")].toInteger();
+
+    static const QRegularExpression numberRegex(QStringLiteral("(\\d+)$"));
+    const bool dos = table[QLatin1String("label")].toString() == QStringLiteral("dos");
+
+    QVariantList partitions;
+    const QJsonArray partitionArray = table[QLatin1String("partitions")].toArray();
+    for (const auto& value : partitionArray) {
+        const QJsonObject partition = value.toObject();
+        const QRegularExpressionMatch match = numberRegex.match(partition[QLatin1String("node")].toString());
+        if (!match.hasMatch())
+            return false;
+
+        qint64 length = partition[QLatin1String("size")].toInteger() * sectorSize;
+
+        // The kernel only maps the first sector(s) of an extended partition
+        const QString type = partition[QLatin1String("type")].toString();
+        if (dos && (type == QStringLiteral("5") || type == QStringLiteral("f") || type == QStringLiteral("85")))
+            length = std::min(length, std::max<qint64>(sectorSize, 1024));
+
+        partitions.append(QVariantMap {
+            { QStringLiteral("number"), match.captured(1).toInt() },
+            { QStringLiteral("start"), partition[QLatin1String("start")].toInteger() * sectorSize },
+            { QStringLiteral("length"), length },
+        });
+    }
+
+    return ExternalCommand().updatePartitions(deviceNode, partitions, timeout);
+}
+
+static bool syncKernel(const QString& deviceNode, bool raid, qint64 sectorSize, quint32 timeout)
 {
-    if (m_device->type() == Device::Type::SoftwareRAID_Device)
+    if (updateKernelPartitions(deviceNode, sectorSize, timeout))
+        return true;
+
+    // Fall back to rereading the whole table and processing all block devices again
+    if (raid)
         ExternalCommand(QStringLiteral("udevadm"), { QStringLiteral("control"), QStringLiteral("--stop-exec-queue") }).run();
 
     ExternalCommand(QStringLiteral("udevadm"), { QStringLiteral("settle"), QStringLiteral("--timeout=") + QString::number(timeout) }).run();
-    ExternalCommand(QStringLiteral("partx"), { QStringLiteral("--update"), m_device->deviceNode() }).run();
+    ExternalCommand partxCommand(QStringLiteral("partx"), { QStringLiteral("--update"), deviceNode });
+    const bool rval = partxCommand.run() && partxCommand.exitCode() == 0;
     ExternalCommand(QStringLiteral("udevadm"), { QStringLiteral("trigger"), QStringLiteral("--subsystem-match=block") }).run();
 
-    if (m_device->type() == Device::Type::SoftwareRAID_Device)
+    if (raid)
         ExternalCommand(QStringLiteral("udevadm"), { QStringLiteral("control"), QStringLiteral("--start-exec-queue") }).run();
 
     ExternalCommand(QStringLiteral("udevadm"), { QStringLiteral("settle"), QStringLiteral("--timeout=") + QString::number(timeout) }).run();
-    return true;
+    return rval;
+}
+
+/* sfdisk writes the partition table itself, this only tells the kernel and udev. Within
+ * a CommitBatch that is done once per device when the batch is flushed.
+ */
+bool SfdiskPartitionTable::commit(quint32 timeout)
+{
+    const QString deviceNode = m_device->deviceNode();
+    const bool raid = m_device->type() == Device::Type::SoftwareRAID_Device;
+    const qint64 sectorSize = m_device->logicalSize();
+    auto sync = [deviceNode, raid, sectorSize, timeout] (Report& report) {
+        if (syncKernel(deviceNode, raid, sectorSize, timeout))
+            return true;
+
+        report.line() << xi18nc("@info:progress", "Could not update the kernel's partitions of device <filename>%1</filename>.", deviceNode);
+        return false;
+    };
+
+    if (CommitBatch::defer(deviceNode, sync))
+        return true;
+
+    Report report(nullptr);
+    return sync(report);
 }
 
 QString SfdiskPartitionTable::createPartition(Report& report, const Partition& partition)
@@ -159,51 +238,6 @@ FileSystem::Type SfdiskPartitionTable::detectFileSystemBySector(Report& report,
     return type;
 }
 
-static struct {
-    FileSystem::Type type;
-    QLatin1String partitionType[2]; // GPT, MBR
-} typemap[] = {
-    { FileSystem::Type::Btrfs, { QLatin1String("0FC63DAF-8483-4772-8E79-3D69D8477DE4"), QLatin1String("83") } },
-    { FileSystem::Type::Ext2, { QLatin1String("0FC63DAF-8483-4772-8E79-3D69D8477DE4"), QLatin1String("83") } },
-    { FileSystem::Type::Ext3, { QLatin1String("0FC63DAF-8483-4772-8E79-3D69D8477DE4"), QLatin1String("83") } },
-    { FileSystem::Type::Ext4, { QLatin1String("0FC63DAF-8483-4772-8E79-3D69D8477DE4"), QLatin1String("83") } },
-    { FileSystem::Type::LinuxSwap, { QLatin1String("0657FD6D-A4AB-43C4-84E5-0933C84B4F4F"), QLatin1String("82") } },
-    { FileSystem::Type::Fat12, { QLatin1String("EBD0A0A2-B9E5-4433-87C0-68B6B72699C7"), QLatin1String("6") } },
-    { FileSystem::Type::Fat16, { QLatin1String("EBD0A0A2-B9E5-4433-87C0-68B6B72699C7"), QLatin1String("6") } },
-    { FileSystem::Type::Fat32, { QLatin1String("EBD0A0A2-B9E5-4433-87C0-68B6B72699C7"), QLatin1String("c") } },
-    { FileSystem::Type::Nilfs2, { QLatin1String("0FC63DAF-8483-4772-8E79-3D69D8477DE4"), QLatin1String("83") } },
-    { FileSystem::Type::Ntfs, { QLatin1String("EBD0A0A2-B9E5-4433-87C0-68B6B72699C7"), QLatin1String("7") } },
-    { FileSystem::Type::Exfat, { QLatin1String("EBD0A0A2-B9E5-4433-87C0-68B6B72699C7"), QLatin1String("7") } },
-    { FileSystem::Type::ReiserFS, { QLatin1String("0FC63DAF-8483-4772-8E79-3D69D8477DE4"), QLatin1String("83") } },
-    { FileSystem::Type::Reiser4, { QLatin1String("0FC63DAF-8483-4772-8E79-3D69D8477DE4"), QLatin1String("83") } },
-    { FileSystem::Type::Xfs, { QLatin1String("0FC63DAF-8483-4772-8E79-3D69D8477DE4"), QLatin1String("83") } },
-    { FileSystem::Type::Jfs, { QLatin1String("0FC63DAF-8483-4772-8E79-3D69D8477DE4"), QLatin1String("83") } },
-    { FileSystem::Type::Hfs, { QLatin1String("48465300-0000-11AA-AA11-00306543ECAC"), QLatin1String("af")} },
-    { FileSystem::Type::HfsPlus, { QLatin1String("48465300-0000-11AA-AA11-00306543ECAC"), QLatin1String("af") } },
-    { FileSystem::Type::Udf, { QLatin1String("EBD0A0A2-B9E5-4433-87C0-68B6B72699C7"), QLatin1String("7") } }
-    // Add ZFS too
-};
-
-static QLatin1String getPartitionType(FileSystem::Type t, PartitionTable::TableType tableType)
-{
-    quint8 type;
-    switch (tableType) {
-    case PartitionTable::TableType::gpt:
-        type = 0;
-        break;
-    case PartitionTable::TableType::msdos:
-        type = 1;
-        break;
-    default:;
-        return QLatin1String();
-    }
-    for (quint32 i = 0; i < sizeof(typemap) / sizeof(typemap[0]); i++)
-        if (typemap[i].type == t)
-            return typemap[i].partitionType[type];
-
-    return QLatin1String();
-}
-
 bool SfdiskPartitionTable::setPartitionLabel(Report& report, const Partition& partition, const QString& label)
 {
     if (label.isEmpty())
@@ -251,7 +285,7 @@ bool SfdiskPartitionTable::setPartitionSystemType(Report& report, const Partitio
 {
     QString partitionType = partition.type();
     if (partitionType.isEmpty())
-        partitionType = getPartitionType(partition.fileSystem().type(), m_device->partitionTable()->type());
+        partitionType = PartitionTypes::forFileSystem(partition.fileSystem().type(), m_device->partitionTable()->type());
     if (partitionType.isEmpty())
         return true;
     ExternalCommand sfdiskCommand(report, QStringLiteral("sfdisk"), { QStringLiteral("--part-type"), m_device->deviceNode(), QString::number(partition.number()),
@@ -24,15 +24,19 @@
 #include "core/copytargetdevice.h"
 #include "util/externalcommand_trustedprefixes.h"
 #include "util/globallog.h"
+#include "util/lvmshell.h"
 #include "util/report.h"
 
 #include "externalcommandhelper_interface.h"
 
 #include <QCryptographicHash>
+#include <QDBusArgument>
 #include <QDBusConnection>
+#include <QDBusMetaType>
 #include <QDBusInterface>
 #include <QDBusReply>
 #include <QEventLoop>
+#include <QFileInfo>
 #include <QtGlobal>
 #include <QStandardPaths>
 #include <QString>
@@ -126,7 +130,10 @@ bool ExternalCommand::start(int timeout)
 
     bool rval = false;
 
-    QDBusPendingCall pcall = interface->RunCommand(cmd, args(), d->m_Input, d->processChannelMode);
+    // LVM commands share one lvm process in the helper while an LvmShell exists
+    const bool lvmShell = LvmShell::isActive() && d->m_Input.isEmpty() && QFileInfo(cmd).fileName() == QStringLiteral("lvm");
+    QDBusPendingCall pcall = lvmShell ? interface->RunLvmCommand(cmd, args(), d->processChannelMode)
+                                      : interface->RunCommand(cmd, args(), d->m_Input, d->processChannelMode);
 
     QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pcall, this);
     QEventLoop loop;
@@ -163,6 +170,103 @@ bool ExternalCommand::start(int timeout)
     return rval;
 }
 
+/** Runs the command once for each target, appending the target to the arguments.
+
+    The helper runs up to maxParallel of the commands at the same time.
+
+    @param targets the last argument of each command, e.g. device nodes
+    @param maxParallel the maximum number of commands running at the same time
+    @param timeout milliseconds after which a command is killed and fails, -1 for no limit
+    @return a map with "success", "exitCode" and "output" per target, in the order
+            of targets, or an empty list if the commands could not be run
+*/
+QList<QVariantMap> ExternalCommand::runForEach(const QStringList& targets, int maxParallel, int timeout)
+{
+    QList<QVariantMap> results;
+    if (command().isEmpty() || targets.isEmpty())
+        return results;
+
+    if ( qEnvironmentVariableIsSet( "KPMCORE_DEBUG" )) {
+        qDebug() << "";
+        qDebug() << xi18nc("@info:status", "Command: %1 %2", command(), args().join(QStringLiteral(" "))) << targets;
+    }
+
+    auto interface = helperInterface();
+    if (!interface)
+        return results;
+
+    QDBusPendingCall pcall = interface->RunCommandForEach(findTrustedCommand(command()), args(), targets, d->processChannelMode, maxParallel, timeout);
+    results = waitForDbusReplies(pcall);
+
+    if (results.size() != targets.size())
+        results.clear();
+
+    return results;
+}
+
+/** Runs several commands at the same time, independent of command() and args().
+
+    @param commands one QStringList per command with the command name followed by its arguments
+    @param maxParallel the maximum number of commands running at the same time
+    @param timeout milliseconds after which a command is killed and fails, -1 for no limit
+    @return a map with "success", "exitCode" and "output" per command, in the order
+            of commands, or an empty list if the commands could not be run
+*/
+QList<QVariantMap> ExternalCommand::runCommands(const QList<QStringList>& commands, int maxParallel, int timeout)
+{
+    QList<QVariantMap> results;
+    if (commands.isEmpty())
+        return results;
+
+    QVariantList commandLines;
+    for (QStringList commandLine : commands) {
+        if (commandLine.isEmpty())
+            return results;
+        commandLine.first() = findTrustedCommand(commandLine.first());
+        commandLines.append(commandLine);
+    }
+
+    auto interface = helperInterface();
+    if (!interface)
+        return results;
+
+    QDBusPendingCall pcall = interface->RunCommands(commandLines, d->processChannelMode, maxParallel, timeout);
+    results = waitForDbusReplies(pcall);
+
+    if (results.size() != commands.size())
+        results.clear();
+
+    return results;
+}
+
+/* Waits for a reply with a list of RunCommand() like replies */
+QList<QVariantMap> ExternalCommand::waitForDbusReplies(QDBusPendingCall& pcall)
+{
+    QList<QVariantMap> results;
+
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pcall, this);
+    QEventLoop loop;
+
+    auto exitLoop = [&] (QDBusPendingCallWatcher *watcher) {
+        loop.exit();
+
+        if (watcher->isError()) {
+            qWarning() << watcher->error();
+            return;
+        }
+
+        // Nested maps arrive as QDBusArgument
+        QDBusPendingReply<QVariantList> reply = *watcher;
+        for (const QVariant& value : reply.value())
+            results.append(value.canConvert<QDBusArgument>() ? qdbus_cast<QVariantMap>(value) : value.toMap());
+    };
+
+    connect(watcher, &QDBusPendingCallWatcher::finished, exitLoop);
+    loop.exec();
+
+    return results;
+}
+
 bool ExternalCommand::copyBlocks(const CopySource& source, CopyTarget& target)
 {
     bool rval = true;
@@ -203,14 +307,25 @@ bool ExternalCommand::copyBlocks(const CopySource& source, CopyTarget& target)
 }
 
 QByteArray ExternalCommand::readData(const CopySourceDevice& source)
+{
+    return readData(source.path(), source.firstByte(), source.length());
+}
+
+/** Reads data from a device through the helper.
+    @param deviceNode the device to read from
+    @param offset first byte to read
+    @param length number of bytes to read, at most 1 MiB
+    @return the data read or an empty QByteArray on error
+*/
+QByteArray ExternalCommand::readData(const QString& deviceNode, const qint64 offset, const qint64 length)
 {
     auto interface = helperInterface();
     if (!interface)
         return {};
 
     // Helper is restricted not to resolve symlinks
-    QFileInfo sourceInfo(source.path());
-    QDBusPendingCall pcall = interface->ReadData(sourceInfo.canonicalFilePath(), source.firstByte(), source.length());
+    QFileInfo sourceInfo(deviceNode);
+    QDBusPendingCall pcall = interface->ReadData(sourceInfo.canonicalFilePath(), offset, length);
 
     QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pcall, this);
 
@@ -258,6 +373,49 @@ bool ExternalCommand::writeFstab(const QByteArray& fileContents)
     return waitForDbusReply(pcall);
 }
 
+/** Tell the kernel about changed partitions of a disk without rereading its whole table.
+    @param deviceNode the disk
+    @param partitions one QVariantMap per partition with "number", and "start" and "length" in bytes
+    @param timeout seconds to wait for udev to process the disk
+    @return true on success
+*/
+bool ExternalCommand::updatePartitions(const QString& deviceNode, const QVariantList& partitions, int timeout)
+{
+    auto interface = helperInterface();
+    if (!interface)
+        return false;
+
+    QDBusPendingCall pcall = interface->UpdatePartitions(deviceNode, partitions, timeout);
+    return waitForDbusReply(pcall);
+}
+
+/** Ask the helper to keep an lvm shell running for LVM commands.
+    @see LvmShell
+    @return true on success
+*/
+bool ExternalCommand::startLvmShell()
+{
+    auto interface = helperInterface();
+    if (!interface)
+        return false;
+
+    QDBusPendingCall pcall = interface->StartLvmShell();
+    return waitForDbusReply(pcall);
+}
+
+/** Release the lvm shell requested with startLvmShell().
+    @return true on success
+*/
+bool ExternalCommand::stopLvmShell()
+{
+    auto interface = helperInterface();
+    if (!interface)
+        return false;
+
+    QDBusPendingCall pcall = interface->StopLvmShell();
+    return waitForDbusReply(pcall);
+}
+
 OrgKdeKpmcoreExternalcommandInterface* ExternalCommand::helperInterface()
 {
     if (!QDBusConnection::systemBus().isConnected()) {
@@ -56,8 +56,12 @@ public:
 public:
     bool copyBlocks(const CopySource& source, CopyTarget& target);
     QByteArray readData(const CopySourceDevice& source);
+    QByteArray readData(const QString& deviceNode, const qint64 offset, const qint64 length);
     bool writeData(Report& commandReport, const QByteArray& buffer, const QString& deviceNode, const quint64 firstByte); // same as copyBlocks but from QByteArray
     bool writeFstab(const QByteArray& fileContents);
+    bool updatePartitions(const QString& deviceNode, const QVariantList& partitions, int timeout);
+    bool startLvmShell();
+    bool stopLvmShell();
 
     /**< @param cmd the command to run */
     void setCommand(const QString& cmd);
@@ -76,6 +80,8 @@ public:
 
     bool start(int timeout = 30000);
     bool run(int timeout = 30000);
+    QList<QVariantMap> runForEach(const QStringList& targets, int maxParallel, int timeout = 30000);
+    QList<QVariantMap> runCommands(const QList<QStringList>& commands, int maxParallel, int timeout = 30000);
 
     /**< @return the exit code */
     int exitCode() const;
@@ -96,6 +102,7 @@ private:
     void setExitCode(int i);
     void onReadOutput();
     bool waitForDbusReply(QDBusPendingCall &pcall);
+    QList<QVariantMap> waitForDbusReplies(QDBusPendingCall &pcall);
     OrgKdeKpmcoreExternalcommandInterface* helperInterface();
 
 private:
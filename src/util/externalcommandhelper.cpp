@@ -13,9 +13,18 @@
 #include "externalcommandhelper.h"
 #include "externalcommand_whitelist.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <filesystem>
 
 #include <fcntl.h>
+#include <unistd.h>
+
+#if defined(Q_OS_LINUX)
+#include <linux/blkpg.h>
+#include <sys/ioctl.h>
+#endif
 
 #include <QtDBus>
 
@@ -25,6 +34,9 @@
 #include <QElapsedTimer>
 #include <QFile>
 #include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QString>
 #include <QVariant>
 
@@ -160,6 +172,179 @@ bool ExternalCommandHelper::WriteFstab(const QByteArray& fstabContents)
     return true;
 }
 
+#if defined(Q_OS_LINUX)
+struct PartitionExtent {
+    qint64 start;
+    qint64 length;
+};
+
+/* Partitions of a disk as the kernel sees them, by partition number. sysfs always
+ * counts in 512 byte sectors.
+ */
+static QMap<int, PartitionExtent> kernelPartitions(const QString& sysfsDir)
+{
+    auto readValue = [] (const QString& fileName) {
+        QFile file(fileName);
+        bool ok = false;
+        const qint64 value = file.open(QIODevice::ReadOnly) ? file.readAll().trimmed().toLongLong(&ok) : -1;
+        return ok ? value : -1;
+    };
+
+    QMap<int, PartitionExtent> result;
+    const QStringList entries = QDir(sysfsDir).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& entry : entries) {
+        const QString dir = sysfsDir + entry + QLatin1Char('/');
+        if (!QFile::exists(dir + QStringLiteral("partition")))
+            continue;
+
+        // Skip partitions that vanish or cannot be read while we look at them
+        const qint64 number = readValue(dir + QStringLiteral("partition"));
+        const qint64 start = readValue(dir + QStringLiteral("start"));
+        const qint64 size = readValue(dir + QStringLiteral("size"));
+        if (number <= 0 || start < 0 || size < 0)
+            continue;
+
+        result.insert(number, { start * 512, size * 512 });
+    }
+
+    return result;
+}
+
+static bool blkpg(int fd, int op, int number, const PartitionExtent& extent)
+{
+    blkpg_partition partition {};
+    partition.pno = number;
+    partition.start = extent.start;
+    partition.length = extent.length;
+
+    blkpg_ioctl_arg arg {};
+    arg.op = op;
+    arg.datalen = sizeof(partition);
+    arg.data = &partition;
+
+    if (ioctl(fd, BLKPG, &arg) != 0) {
+        qWarning() << "BLKPG operation" << op << "on partition" << number << "failed:" << strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+static bool runUdevadm(const QStringList& arguments, int timeout)
+{
+    const QString udevadm = findTrustedCommand(QStringLiteral("udevadm"));
+    if (udevadm.isEmpty())
+        return false;
+
+    QProcess cmd;
+    cmd.start(udevadm, arguments);
+    if (!cmd.waitForFinished(timeout * 1000)) {
+        cmd.kill();
+        cmd.waitForFinished();
+        return false;
+    }
+    return cmd.exitStatus() == QProcess::NormalExit && cmd.exitCode() == 0;
+}
+#endif
+
+/** Tells the kernel about the partitions of a disk and lets udev process them.
+
+    Only partitions that were added, removed or resized are changed, with BLKPG
+    ioctls. Unlike rereading the whole table this works while other partitions of
+    the disk are in use. udev is then triggered and waited for on the disk and its
+    partitions only instead of on every block device of the system.
+
+    @param deviceNode the disk
+    @param partitions one map per partition of the table with "number", and "start" and "length" in bytes
+    @param timeout seconds to wait for udev
+    @return true on success, false if the kernel could not be updated
+*/
+bool ExternalCommandHelper::UpdatePartitions(const QString& deviceNode, const QVariantList& partitions, const int timeout)
+{
+    if (!isCallerAuthorized()) {
+        return false;
+    }
+
+#if defined(Q_OS_LINUX)
+    if (deviceNode.left(5) != QStringLiteral("/dev/") || !std::filesystem::is_block_file(deviceNode.toStdU16String())) {
+        qWarning() << "Not a block device";
+        return false;
+    }
+
+    const QString canonicalPath = QFileInfo(deviceNode).canonicalFilePath();
+    const QString sysfsDir = QStringLiteral("/sys/class/block/") + QFileInfo(canonicalPath).fileName() + QLatin1Char('/');
+    if (!QFileInfo::exists(sysfsDir) || QFileInfo::exists(sysfsDir + QStringLiteral("partition"))) {
+        qWarning() << deviceNode << "is not a disk";
+        return false;
+    }
+
+    QMap<int, PartitionExtent> wanted;
+    for (const QVariant& value : partitions) {
+        const QVariantMap partition = value.canConvert<QDBusArgument>() ? qdbus_cast<QVariantMap>(value) : value.toMap();
+        const int number = partition.value(QStringLiteral("number")).toInt();
+        const PartitionExtent extent { partition.value(QStringLiteral("start")).toLongLong(), partition.value(QStringLiteral("length")).toLongLong() };
+        if (number <= 0 || extent.start < 0 || extent.length <= 0) {
+            return false;
+        }
+        wanted.insert(number, extent);
+    }
+
+    const QMap<int, PartitionExtent> current = kernelPartitions(sysfsDir);
+
+    int fd = open(canonicalPath.toLocal8Bit().constData(), O_RDONLY | O_CLOEXEC | O_NONBLOCK);
+    if (fd < 0) {
+        qWarning() << "Failed to open device" << deviceNode;
+        return false;
+    }
+
+    // Remove first and shrink before growing, so no step overlaps a partition that is still there
+    bool rval = true;
+    for (auto it = current.cbegin(); it != current.cend() && rval; ++it) {
+        const auto w = wanted.constFind(it.key());
+        if (w == wanted.cend() || w->start != it->start)
+            rval = blkpg(fd, BLKPG_DEL_PARTITION, it.key(), *it);
+    }
+    for (const bool shrink : { true, false }) {
+        for (auto it = wanted.cbegin(); it != wanted.cend() && rval; ++it) {
+            const auto c = current.constFind(it.key());
+            if (c != current.cend() && c->start == it->start && c->length != it->length && (it->length < c->length) == shrink)
+                rval = blkpg(fd, BLKPG_RESIZE_PARTITION, it.key(), *it);
+        }
+    }
+    for (auto it = wanted.cbegin(); it != wanted.cend() && rval; ++it) {
+        const auto c = current.constFind(it.key());
+        if (c == current.cend() || c->start != it->start)
+            rval = blkpg(fd, BLKPG_ADD_PARTITION, it.key(), *it);
+    }
+    close(fd);
+
+    if (!rval) {
+        return false;
+    }
+
+    // Attributes like partition labels may have changed too, so let udev look at all partitions of the disk
+    QStringList devices { sysfsDir };
+    const QStringList entries = QDir(sysfsDir).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& entry : entries) {
+        if (QFileInfo::exists(sysfsDir + entry + QStringLiteral("/partition")))
+            devices.append(sysfsDir + entry);
+    }
+
+    // --settle waits for the triggered events only, it needs systemd 238
+    const QStringList trigger { QStringLiteral("trigger"), QStringLiteral("--action=change") };
+    if (!runUdevadm(trigger + QStringList { QStringLiteral("--settle") } + devices, timeout)) {
+        runUdevadm(trigger + devices, timeout);
+        runUdevadm({ QStringLiteral("settle"), QStringLiteral("--timeout=") + QString::number(timeout) }, timeout + 1);
+    }
+
+    return true;
+#else
+    Q_UNUSED(deviceNode)
+    Q_UNUSED(partitions)
+    Q_UNUSED(timeout)
+    return false;
+#endif
+}
+
 // If targetDevice is empty then return QByteArray with data that was read from disk.
 QVariantMap ExternalCommandHelper::CopyFileData(const QString& sourceDevice, const qint64 sourceOffset, const qint64 sourceLength, const QString& targetDevice, const qint64 targetOffset, const qint64 chunkSize)
 {
@@ -312,7 +497,7 @@ QByteArray ExternalCommandHelper::ReadData(const QString& device, const qint64 o
         qWarning() << "ReadData: device should not be symbolic link";
         return {};
     }
-    if (device.left(5) != QStringLiteral("/dev/") || device.left(9) != QStringLiteral("/dev/shm/")) {
+    if (device.left(5) != QStringLiteral("/dev/") || device.left(9) == QStringLiteral("/dev/shm/")) {
         qWarning() << "Error: trying to read data from device not in /dev";
         return {};
     }
@@ -364,28 +549,7 @@ QVariantMap ExternalCommandHelper::RunCommand(const QString& command, const QStr
     QVariantMap reply;
     reply[QStringLiteral("success")] = false;
 
-    if (command.isEmpty()) {
-        return reply;
-    }
-
-    // Compare with command whitelist
-    QFileInfo fileInfo(command);
-    QString basename = fileInfo.fileName();
-    if (allowedCommands.find(basename) == allowedCommands.end()) { // TODO: C++20: replace with contains
-        qInfo() << command << "command is not one of the whitelisted commands";
-        reply[QStringLiteral("success")] = false;
-        return reply;
-    }
-
-    // Make sure command is located in the trusted prefix
-    QDir prefix = fileInfo.absoluteDir();
-    QString dirname = prefix.dirName();
-    if (dirname == QStringLiteral("bin") || dirname == QStringLiteral("sbin")) {
-        prefix.cdUp();
-    }
-    if (trustedPrefixes.find(prefix.path()) == trustedPrefixes.end()) { // TODO: C++20: replace with contains
-        qInfo() << prefix.path() << "prefix is not one of the trusted command prefixes";
-        reply[QStringLiteral("success")] = false;
+    if (!isCommandTrusted(command)) {
         return reply;
     }
 
@@ -410,6 +574,367 @@ QVariantMap ExternalCommandHelper::RunCommand(const QString& command, const QStr
     return reply;
 }
 
+/** Runs a command once for each target with the target appended to the arguments.
+
+    Up to maxParallel processes run at the same time, so querying many devices with
+    tools like smartctl that mostly wait for the device takes about as long as the
+    slowest device instead of the sum of all of them.
+
+    @param timeout milliseconds after which a process is killed and reported as failed, -1 for no limit
+    @return one reply like RunCommand() returns per target, in the order of targets
+*/
+QVariantList ExternalCommandHelper::RunCommandForEach(const QString& command, const QStringList& arguments, const QStringList& targets, const int processChannelMode, const int maxParallel, const int timeout)
+{
+    if (!isCallerAuthorized()) {
+        return {};
+    }
+
+    if (!isCommandTrusted(command)) {
+        return {};
+    }
+
+    QList<QStringList> commandLines;
+    for (const QString& target : targets)
+        commandLines.append(QStringList { command } + arguments + QStringList { target });
+
+    return runParallel(commandLines, processChannelMode, maxParallel, timeout);
+}
+
+/** Runs several commands at the same time.
+
+    @param commands one QStringList per command with the command followed by its arguments
+    @param timeout milliseconds after which a process is killed and reported as failed, -1 for no limit
+    @return one reply like RunCommand() returns per command, in the order of commands
+*/
+QVariantList ExternalCommandHelper::RunCommands(const QVariantList& commands, const int processChannelMode, const int maxParallel, const int timeout)
+{
+    if (!isCallerAuthorized()) {
+        return {};
+    }
+
+    QList<QStringList> commandLines;
+    for (const QVariant& command : commands) {
+        const QStringList commandLine = command.toStringList();
+        if (commandLine.isEmpty() || !isCommandTrusted(commandLine.first()))
+            return {};
+        commandLines.append(commandLine);
+    }
+
+    return runParallel(commandLines, processChannelMode, maxParallel, timeout);
+}
+
+/* Runs the command lines with up to maxParallel processes at the same time. Processes
+ * still running timeout ms after they were started are killed and reported as failed.
+ */
+QVariantList ExternalCommandHelper::runParallel(const QList<QStringList>& commandLines, const int processChannelMode, const int maxParallel, const int timeout)
+{
+    constexpr int maxProcesses = 16;
+
+    if (commandLines.isEmpty()) {
+        return {};
+    }
+
+    if((processChannelMode != QProcess::SeparateChannels) && (processChannelMode != QProcess::MergedChannels)) {
+        return {};
+    }
+
+    QVariantList replies(commandLines.size());
+    std::vector<std::unique_ptr<QProcess>> processes(commandLines.size());
+    std::vector<QElapsedTimer> timers(commandLines.size());
+    QList<qsizetype> running;
+    qsizetype next = 0;
+
+    auto start = [&] (qsizetype i) {
+        processes[i] = std::make_unique<QProcess>();
+        QProcess* cmd = processes[i].get();
+        cmd->setEnvironment( { QStringLiteral("LVM_SUPPRESS_FD_WARNINGS=1") } );
+        cmd->setProcessChannelMode(static_cast<QProcess::ProcessChannelMode>(processChannelMode));
+        cmd->start(commandLines[i].first(), commandLines[i].mid(1));
+        cmd->closeWriteChannel();
+        timers[i].start();
+        running.append(i);
+    };
+
+    auto finish = [&] (qsizetype i, bool timedOut) {
+        QProcess* cmd = processes[i].get();
+        QVariantMap reply;
+        reply[QStringLiteral("output")] = cmd->readAllStandardOutput();
+        reply[QStringLiteral("exitCode")] = cmd->exitCode();
+        reply[QStringLiteral("success")] = !timedOut && cmd->error() != QProcess::FailedToStart;
+        replies[i] = reply;
+        processes[i].reset();
+    };
+
+    while (next < commandLines.size() || !running.isEmpty()) {
+        while (next < commandLines.size() && running.size() < std::clamp(maxParallel, 1, maxProcesses))
+            start(next++);
+
+        // Wait for the processes in turn with a short timeout. This also reads their
+        // output, so none of them blocks on a full pipe for long.
+        for (qsizetype j = 0; j < running.size(); ) {
+            QProcess* cmd = processes[running[j]].get();
+            if (cmd->waitForFinished(100) || cmd->state() == QProcess::NotRunning) {
+                finish(running[j], false);
+                running.removeAt(j);
+            }
+            else if (timeout >= 0 && timers[running[j]].hasExpired(timeout)) {
+                qWarning() << "Killing" << commandLines[running[j]].first() << "after" << timeout << "ms";
+                cmd->kill();
+                cmd->waitForFinished(1000);
+                finish(running[j], true);
+                running.removeAt(j);
+            }
+            else
+                ++j;
+        }
+    }
+
+    return replies;
+}
+
+/** Runs an LVM command in the persistent lvm shell.
+
+    Commands that change LVM metadata are sent to a single "lvm" shell process that is
+    kept open between StartLvmShell() and StopLvmShell(), so LVM does not have to
+    initialize, scan devices and set up locking for every command. The exit status is
+    taken from the JSON log report the shell writes to a separate file descriptor.
+
+    Commands with reports that callers parse, and all commands when no shell is
+    requested or it cannot be started, are run as a separate process like RunCommand().
+*/
+QVariantMap ExternalCommandHelper::RunLvmCommand(const QString& command, const QStringList& arguments, const int processChannelMode)
+{
+    // Commands that only change metadata and whose output is not parsed
+    static const std::unordered_set<QString> shellCommands {
+        QStringLiteral("lvchange"),
+        QStringLiteral("lvcreate"),
+        QStringLiteral("lvremove"),
+        QStringLiteral("lvresize"),
+        QStringLiteral("pvcreate"),
+        QStringLiteral("pvremove"),
+        QStringLiteral("pvresize"),
+        QStringLiteral("vgchange"),
+        QStringLiteral("vgcreate"),
+        QStringLiteral("vgextend"),
+        QStringLiteral("vgreduce"),
+        QStringLiteral("vgremove"),
+    };
+
+    if (!isCallerAuthorized()) {
+        return {};
+    }
+
+    QVariantMap reply;
+    reply[QStringLiteral("success")] = false;
+
+    if (QFileInfo(command).fileName() != QStringLiteral("lvm") || !isCommandTrusted(command)) {
+        return reply;
+    }
+
+    // The shell only understands simple quoting and splits a line into at most 64
+    // arguments, let the rest go through a separate process
+    constexpr qsizetype maxShellArguments = 64;
+    bool useShell = m_LvmShellUsers > 0 && processChannelMode == QProcess::MergedChannels
+            && !arguments.isEmpty() && arguments.size() < maxShellArguments
+            && shellCommands.find(arguments.first()) != shellCommands.end();
+    for (const QString& argument : arguments) {
+        if (argument.contains(QLatin1Char('\'')) || argument.contains(QLatin1Char('\n')))
+            useShell = false;
+    }
+
+    if (!useShell || !startLvmShell(command)) {
+        return RunCommand(command, arguments, {}, processChannelMode);
+    }
+
+    QByteArray output;
+    int exitCode;
+    if (!runInLvmShell(arguments, output, exitCode)) {
+        // The shell died or hung while running the command, it is not known whether the command ran.
+        // Start a new one, so later commands do not have to wait for it.
+        qWarning() << "lvm shell did not complete" << arguments.first() << ", restarting it";
+        stopLvmShell(true);
+        startLvmShell(command);
+        reply[QStringLiteral("output")] = output;
+        reply[QStringLiteral("exitCode")] = -1;
+        return reply;
+    }
+
+    reply[QStringLiteral("output")] = output;
+    reply[QStringLiteral("exitCode")] = exitCode == -1 ? 5 : exitCode; // ECMD_FAILED if there is no status
+    reply[QStringLiteral("success")] = true;
+    return reply;
+}
+
+/** Runs one command in the lvm shell.
+    @param arguments the lvm command and its arguments
+    @param output the text the command printed
+    @param exitCode 0 on success, 5 if the command failed or -1 if lvm reported no status
+    @return true if the shell completed the command
+*/
+bool ExternalCommandHelper::runInLvmShell(const QStringList& arguments, QByteArray& output, int& exitCode)
+{
+    QStringList quoted;
+    for (const QString& argument : arguments) {
+        quoted << QLatin1Char('\'') + argument + QLatin1Char('\'');
+    }
+    quoted << QStringLiteral("--reportformat") << QStringLiteral("json")
+           << QStringLiteral("--config") << QStringLiteral("'log/report_command_log=1 log/command_log_selection=\"all\"'");
+
+    m_LvmShell->write(quoted.join(QLatin1Char(' ')).toLocal8Bit() + '\n');
+
+    // Metadata commands take seconds, a command that is still running after this is considered hung
+    constexpr int commandTimeout = 5 * 60 * 1000;
+
+    QByteArray logReport;
+    if (!readLvmShellResponse(output, logReport, commandTimeout)) {
+        return false;
+    }
+
+    // The status entry of the command has ret code 1 on success, like lvmdbusd checks it
+    exitCode = -1;
+    const QJsonArray log = QJsonDocument::fromJson(logReport).object().value(QStringLiteral("log")).toArray();
+    for (const QJsonValue& entry : log) {
+        const QJsonObject item = entry.toObject();
+        if (item.value(QStringLiteral("log_type")).toString() == QStringLiteral("status")
+                && item.value(QStringLiteral("log_object_type")).toString() == QStringLiteral("cmd"))
+            exitCode = item.value(QStringLiteral("log_ret_code")).toString() == QStringLiteral("1") ? 0 : 5;
+    }
+
+    return true;
+}
+
+/** Keep an lvm shell running for LVM commands until StopLvmShell() is called.
+
+    Calls are counted, the shell is started with the first command that needs it.
+*/
+bool ExternalCommandHelper::StartLvmShell()
+{
+    if (!isCallerAuthorized()) {
+        return false;
+    }
+
+    ++m_LvmShellUsers;
+    return true;
+}
+
+bool ExternalCommandHelper::StopLvmShell()
+{
+    if (!isCallerAuthorized() || m_LvmShellUsers == 0) {
+        return false;
+    }
+
+    if (--m_LvmShellUsers == 0) {
+        stopLvmShell();
+    }
+    return true;
+}
+
+bool ExternalCommandHelper::startLvmShell(const QString& command)
+{
+    if (m_LvmShell && m_LvmShell->state() == QProcess::Running && m_LvmShellCommand == command) {
+        return true;
+    }
+
+    stopLvmShell();
+
+    int reportPipe[2];
+    if (pipe2(reportPipe, O_CLOEXEC) != 0) {
+        return false;
+    }
+
+    // lvm writes the JSON reports, including the log report with the exit status, to LVM_REPORT_FD
+    constexpr int reportFd = 3;
+    const int writeFd = reportPipe[1];
+    m_LvmShell = std::make_unique<QProcess>();
+    m_LvmShell->setEnvironment( { QStringLiteral("LVM_SUPPRESS_FD_WARNINGS=1"), QStringLiteral("LVM_REPORT_FD=%1").arg(reportFd) } );
+    m_LvmShell->setProcessChannelMode(QProcess::MergedChannels);
+    m_LvmShell->setChildProcessModifier([writeFd] {
+        if (writeFd == reportFd)
+            fcntl(reportFd, F_SETFD, 0);
+        else
+            dup2(writeFd, reportFd);
+    });
+    m_LvmShell->start(command, {});
+    close(writeFd);
+
+    m_LvmReportFd = reportPipe[0];
+    fcntl(m_LvmReportFd, F_SETFL, O_NONBLOCK);
+    m_LvmShellCommand = command;
+
+    // Wait for the first prompt, lvm without readline support has no shell.
+    // Then make sure this lvm reports the status of commands.
+    QByteArray output, report;
+    int exitCode = -1;
+    if (!m_LvmShell->waitForStarted() || !readLvmShellResponse(output, report, 10000)
+            || !runInLvmShell({ QStringLiteral("version") }, output, exitCode) || exitCode != 0) {
+        qWarning() << "Could not start lvm shell, running LVM commands as separate processes";
+        stopLvmShell();
+        return false;
+    }
+
+    return true;
+}
+
+/** Stops the lvm shell.
+    @param kill kill the shell right away instead of asking it to exit, e.g. because it hangs
+*/
+void ExternalCommandHelper::stopLvmShell(bool kill)
+{
+    if (m_LvmShell) {
+        if (!kill) {
+            m_LvmShell->write("exit\n");
+            m_LvmShell->closeWriteChannel();
+        }
+        if (kill || !m_LvmShell->waitForFinished(5000)) {
+            m_LvmShell->kill();
+            m_LvmShell->waitForFinished();
+        }
+        m_LvmShell.reset();
+    }
+
+    if (m_LvmReportFd >= 0) {
+        close(m_LvmReportFd);
+        m_LvmReportFd = -1;
+    }
+}
+
+/** Reads the output of the lvm shell up to the next prompt.
+    @param output the text the command printed, without the prompt
+    @param report the data written to the report file descriptor
+    @param timeout time to wait in milliseconds
+    @return true if the prompt was read
+*/
+bool ExternalCommandHelper::readLvmShellResponse(QByteArray& output, QByteArray& report, int timeout)
+{
+    const QByteArray prompt = QByteArrayLiteral("lvm> ");
+    QElapsedTimer timer;
+    timer.start();
+
+    // Drain the report pipe while waiting, so lvm never blocks on a full pipe
+    auto readReport = [this, &report] {
+        char buffer[4096];
+        ssize_t n;
+        while ((n = read(m_LvmReportFd, buffer, sizeof(buffer))) > 0)
+            report.append(buffer, n);
+    };
+
+    while (!output.endsWith(prompt)) {
+        readReport();
+        if (!m_LvmShell->waitForReadyRead(100) && m_LvmShell->state() != QProcess::Running) {
+            return false;
+        }
+        output += m_LvmShell->readAllStandardOutput();
+
+        if (timeout >= 0 && timer.hasExpired(timeout)) {
+            return false;
+        }
+    }
+
+    readReport();
+    output.chop(prompt.size());
+    return true;
+}
+
 void ExternalCommandHelper::onReadOutput()
 {
 /*    const QByteArray s = cmd.readAllStandardOutput();
@@ -426,6 +951,35 @@ void ExternalCommandHelper::onReadOutput()
          *report() << QString::fromLocal8Bit(s);*/
 }
 
+/** @return true if command is whitelisted and located in a trusted prefix */
+bool ExternalCommandHelper::isCommandTrusted(const QString& command)
+{
+    if (command.isEmpty()) {
+        return false;
+    }
+
+    // Compare with command whitelist
+    QFileInfo fileInfo(command);
+    QString basename = fileInfo.fileName();
+    if (allowedCommands.find(basename) == allowedCommands.end()) { // TODO: C++20: replace with contains
+        qInfo() << command << "command is not one of the whitelisted commands";
+        return false;
+    }
+
+    // Make sure command is located in the trusted prefix
+    QDir prefix = fileInfo.absoluteDir();
+    QString dirname = prefix.dirName();
+    if (dirname == QStringLiteral("bin") || dirname == QStringLiteral("sbin")) {
+        prefix.cdUp();
+    }
+    if (trustedPrefixes.find(prefix.path()) == trustedPrefixes.end()) { // TODO: C++20: replace with contains
+        qInfo() << prefix.path() << "prefix is not one of the trusted command prefixes";
+        return false;
+    }
+
+    return true;
+}
+
 bool ExternalCommandHelper::isCallerAuthorized()
 {
     if (!calledFromDBus()) {
@@ -39,17 +39,35 @@ public:
 
 public Q_SLOTS:
     Q_SCRIPTABLE QVariantMap RunCommand(const QString& command, const QStringList& arguments, const QByteArray& input, const int processChannelMode);
+    Q_SCRIPTABLE QVariantList RunCommandForEach(const QString& command, const QStringList& arguments, const QStringList& targets, const int processChannelMode, const int maxParallel, const int timeout);
+    Q_SCRIPTABLE QVariantList RunCommands(const QVariantList& commands, const int processChannelMode, const int maxParallel, const int timeout);
     Q_SCRIPTABLE QVariantMap CopyFileData(const QString& sourceDevice, const qint64 sourceOffset, const qint64 sourceLength,
                                         const QString& targetDevice, const qint64 targetOffset, const qint64 blockSize);
     Q_SCRIPTABLE QByteArray ReadData(const QString& device, const qint64 offset, const qint64 length);
     Q_SCRIPTABLE bool WriteData(const QByteArray& buffer, const QString& targetDevice, const qint64 targetOffset);
     Q_SCRIPTABLE bool WriteFstab(const QByteArray& fstabContents);
+    Q_SCRIPTABLE bool UpdatePartitions(const QString& deviceNode, const QVariantList& partitions, const int timeout);
+    Q_SCRIPTABLE QVariantMap RunLvmCommand(const QString& command, const QStringList& arguments, const int processChannelMode);
+    Q_SCRIPTABLE bool StartLvmShell();
+    Q_SCRIPTABLE bool StopLvmShell();
 
 private:
     bool isCallerAuthorized();
+    bool isCommandTrusted(const QString& command);
+    QVariantList runParallel(const QList<QStringList>& commandLines, const int processChannelMode, const int maxParallel, const int timeout);
+
+    bool startLvmShell(const QString& command);
+    void stopLvmShell(bool kill = false);
+    bool runInLvmShell(const QStringList& arguments, QByteArray& output, int& exitCode);
+    bool readLvmShellResponse(QByteArray& output, QByteArray& report, int timeout);
 
     void onReadOutput();
     QDBusServiceWatcher *m_serviceWatcher = nullptr;
+
+    std::unique_ptr<QProcess> m_LvmShell;
+    QString m_LvmShellCommand;
+    int m_LvmReportFd = -1;
+    int m_LvmShellUsers = 0;
 };
 
 #endif
@@ -0,0 +1,31 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "util/lvmshell.h"
+#include "util/externalcommand.h"
+
+static thread_local int activeShells = 0;
+
+LvmShell::LvmShell() :
+    m_Started(ExternalCommand().startLvmShell())
+{
+    if (m_Started)
+        ++activeShells;
+}
+
+LvmShell::~LvmShell()
+{
+    if (m_Started) {
+        --activeShells;
+        ExternalCommand().stopLvmShell();
+    }
+}
+
+/** @return true if LVM commands of this thread should be sent to the lvm shell */
+bool LvmShell::isActive()
+{
+    return activeShells > 0;
+}
@@ -0,0 +1,41 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_LVMSHELL_H
+#define KPMCORE_LVMSHELL_H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include <QtGlobal>
+
+/** Scope in which LVM commands share one lvm process.
+
+    While an LvmShell exists, ExternalCommand sends "lvm" commands of the calling
+    thread to an interactive lvm shell kept open by the helper instead of starting
+    a new lvm process for each of them. LVM then initializes, scans devices and sets
+    up locking once per scan or operation run instead of once per command.
+
+    Commands whose output is parsed are still run as separate processes by the
+    helper, so callers do not need to know whether a shell is used.
+
+    @author kpmcore contributors
+*/
+class LIBKPMCORE_EXPORT LvmShell
+{
+    Q_DISABLE_COPY(LvmShell)
+
+public:
+    LvmShell();
+    ~LvmShell();
+
+public:
+    static bool isActive();
+
+private:
+    bool m_Started;
+};
+
+#endif
@@ -0,0 +1,105 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <QObject>
+
+#include <QtTest>
+
+#include "core/diskdevice.h"
+#include "core/operationstack.h"
+#include "core/partition.h"
+#include "core/partitiontable.h"
+#include "fs/filesystemfactory.h"
+#include "ops/copyoperation.h"
+#include "ops/resizeoperation.h"
+
+/* Gives the test access to adding Devices, which is otherwise done by DeviceScanner */
+class TestStack : public OperationStack
+{
+public:
+    using OperationStack::addDevice;
+};
+
+class OperationStackTest : public QObject
+{
+    Q_OBJECT
+
+private:
+    static DiskDevice* addDevice(TestStack& stack, const QString& deviceNode)
+    {
+        DiskDevice* device = new DiskDevice(QStringLiteral("Test"), deviceNode, 512, 1000000);
+        device->setPartitionTable(new PartitionTable(PartitionTable::gpt, 2048, 999966));
+        device->partitionTable()->updateUnallocated(*device);
+        stack.addDevice(device);
+        return device;
+    }
+
+    static Partition* addPartition(DiskDevice& device, qint64 first, qint64 last)
+    {
+        PartitionTable* table = device.partitionTable();
+        FileSystem* fs = FileSystemFactory::create(FileSystem::Type::Ext4, first, last, device.logicalSize());
+        Partition* p = new Partition(table, device, PartitionRole(PartitionRole::Primary), fs, first, last, device.deviceNode() + QStringLiteral("1"));
+        table->append(p);
+        table->updateUnallocated(device);
+        return p;
+    }
+
+private Q_SLOTS:
+
+    void testMergeResize()
+    {
+        TestStack stack;
+        DiskDevice* device = addDevice(stack, QStringLiteral("/dev/kpmcoretesta"));
+        Partition* p = addPartition(*device, 2048, 99999);
+
+        stack.push(new ResizeOperation(*device, *p, 2048, 149999));
+        stack.push(new ResizeOperation(*device, *p, 4096, 149999));
+
+        QCOMPARE(stack.operations().size(), 1);
+        const ResizeOperation* op = dynamic_cast<const ResizeOperation*>(stack.operations().first());
+        QVERIFY(op);
+        QCOMPARE(op->origFirstSector(), qint64(2048));
+        QCOMPARE(op->origLastSector(), qint64(99999));
+        QCOMPARE(op->newFirstSector(), qint64(4096));
+        QCOMPARE(p->firstSector(), qint64(4096));
+        QCOMPARE(p->lastSector(), qint64(149999));
+
+        // Back where it started: nothing left to do
+        stack.push(new ResizeOperation(*device, *p, 2048, 99999));
+        QVERIFY(stack.operations().isEmpty());
+        QCOMPARE(p->firstSector(), qint64(2048));
+        QCOMPARE(p->lastSector(), qint64(99999));
+    }
+
+    void testNoMergeAfterCopy()
+    {
+        TestStack stack;
+        DiskDevice* source = addDevice(stack, QStringLiteral("/dev/kpmcoretesta"));
+        DiskDevice* target = addDevice(stack, QStringLiteral("/dev/kpmcoretestb"));
+        Partition* p = addPartition(*source, 2048, 99999);
+
+        stack.push(new ResizeOperation(*source, *p, 2048, 149999));
+
+        // The copy is on another device, but it copies the resized partition
+        Partition* unallocated = target->partitionTable()->findPartitionBySector(2048, PartitionRole(PartitionRole::Unallocated));
+        QVERIFY(unallocated);
+        Partition* copy = CopyOperation::createCopy(*unallocated, *p);
+        copy->setParent(target->partitionTable());
+        stack.push(new CopyOperation(*target, copy, *source, p));
+
+        stack.push(new ResizeOperation(*source, *p, 4096, 149999));
+
+        QCOMPARE(stack.operations().size(), 3);
+        const ResizeOperation* first = dynamic_cast<const ResizeOperation*>(stack.operations().first());
+        QVERIFY(first);
+        QCOMPARE(first->newFirstSector(), qint64(2048));
+        QCOMPARE(first->newLastSector(), qint64(149999));
+    }
+};
+
+QTEST_GUILESS_MAIN(OperationStackTest)
+
+#include "test_operationstack.moc"
@@ -0,0 +1,93 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <QObject>
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTimeZone>
+#include <QtTest>
+
+#include <cmath>
+
+#include "core/smarthistory.h"
+
+class SmartHistoryTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+
+    void testAppendAndReplay()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+
+        const QDateTime start = QDateTime::fromSecsSinceEpoch(1700000000, QTimeZone::UTC);
+        {
+            SmartHistory history(dir.path());
+            for (int day = 0; day < 15; ++day) {
+                const QHash<quint32, qint64> values {
+                    { 5, day },                                          // reallocated sectors
+                    { SmartHistory::Temperature, 300000 + (day % 5) * 1000 },
+                    { SmartHistory::PowerCycles, 42 },
+                };
+                QVERIFY(history.append(QStringLiteral("disk"), values, start.addDays(day)));
+            }
+        }
+
+        // A new instance continues from the values in the file
+        SmartHistory history(dir.path());
+        QVERIFY(history.append(QStringLiteral("disk"), { { 5, 15 } }, start.addDays(15)));
+
+        QCOMPARE(history.disks(), QStringList { QStringLiteral("disk") });
+
+        const QList<SmartHistory::Sample> sectors = history.samples(QStringLiteral("disk"), 5);
+        QCOMPARE(sectors.size(), 16);
+        QCOMPARE(sectors.first().time, start);
+        QCOMPARE(sectors.last().value, qint64(15));
+
+        // Unchanged values are carried forward
+        QCOMPARE(history.samples(QStringLiteral("disk"), SmartHistory::PowerCycles).size(), 16);
+
+        QCOMPARE(history.ratePerWeek(QStringLiteral("disk"), 5), 7.0);
+        QVERIFY(std::isnan(history.ratePerWeek(QStringLiteral("disk"), 5, start.addDays(7), start.addDays(7))));
+
+        QCOMPARE(history.percentile(QStringLiteral("disk"), SmartHistory::Temperature, 50), qint64(302000));
+        QCOMPARE(history.percentile(QStringLiteral("disk"), SmartHistory::Temperature, 100), qint64(304000));
+        QCOMPARE(history.percentile(QStringLiteral("other"), SmartHistory::Temperature, 50), qint64(-1));
+    }
+
+    void testTruncatedRecord()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+
+        const QDateTime start = QDateTime::fromSecsSinceEpoch(1700000000, QTimeZone::UTC);
+        {
+            SmartHistory history(dir.path());
+            QVERIFY(history.append(QStringLiteral("disk"), { { 194, 35 } }, start));
+            QVERIFY(history.append(QStringLiteral("disk"), { { 194, 40 } }, start.addSecs(3600)));
+        }
+
+        QFile file(dir.path() + QStringLiteral("/disk.smarthistory"));
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QVERIFY(file.resize(file.size() - 1));
+        file.close();
+
+        SmartHistory history(dir.path());
+        QCOMPARE(history.samples(QStringLiteral("disk"), 194).size(), 1);
+
+        QVERIFY(history.append(QStringLiteral("disk"), { { 194, 38 } }, start.addSecs(7200)));
+        const QList<SmartHistory::Sample> temperatures = history.samples(QStringLiteral("disk"), 194);
+        QCOMPARE(temperatures.size(), 2);
+        QCOMPARE(temperatures.last().value, qint64(38));
+    }
+};
+
+QTEST_GUILESS_MAIN(SmartHistoryTest)
+
+#include "test_smarthistory.moc"
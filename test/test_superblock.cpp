@@ -0,0 +1,188 @@
+/*
+    SPDX-FileCopyrightText: 2026 kpmcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <QObject>
+
+#include <QtEndian>
+#include <QtTest>
+
+#include "fs/superblock.h"
+
+template <typename T>
+static void putLE(QByteArray& data, qint64 offset, T value)
+{
+    qToLittleEndian<T>(value, data.data() + offset);
+}
+
+template <typename T>
+static void putBE(QByteArray& data, qint64 offset, T value)
+{
+    qToBigEndian<T>(value, data.data() + offset);
+}
+
+class SuperblockTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+
+    void testExt2()
+    {
+        QByteArray sb(Superblock::ext2Layout.length, 0);
+        QCOMPARE(Superblock::ext2UsedBytes(sb), qint64(-1));
+
+        putLE<quint16>(sb, 0x38, 0xEF53);
+        putLE<quint32>(sb, 0x04, 1000);   // blocks
+        putLE<quint32>(sb, 0x0C, 400);    // free blocks
+        putLE<quint32>(sb, 0x18, 2);      // 4 KiB blocks
+        QCOMPARE(Superblock::ext2UsedBytes(sb), qint64(600) * 4096);
+
+        putLE<quint32>(sb, 0x60, 0x80);   // 64bit
+        putLE<quint32>(sb, 0x150, 1);
+        QCOMPARE(Superblock::ext2UsedBytes(sb), ((1LL << 32) + 600) * 4096);
+    }
+
+    void testXfs()
+    {
+        QByteArray sb(Superblock::xfsLayout.length, 0);
+        QCOMPARE(Superblock::xfsUsedBytes(sb), qint64(-1));
+
+        putBE<quint32>(sb, 0, 0x58465342);
+        putBE<quint32>(sb, 4, 4096);
+        putBE<quint64>(sb, 8, 262144);
+        putBE<quint64>(sb, 144, 200000);
+        QCOMPARE(Superblock::xfsUsedBytes(sb), 62144LL * 4096);
+    }
+
+    void testBtrfs()
+    {
+        QByteArray sb(Superblock::btrfsLayout.length, 0);
+        QCOMPARE(Superblock::btrfsUsedBytes(sb), qint64(-1));
+
+        sb.replace(0x40, 8, "_BHRfS_M");
+        putLE<quint64>(sb, 0xC9 + 16, 123456789);
+        QCOMPARE(Superblock::btrfsUsedBytes(sb), qint64(123456789));
+    }
+
+    void testFat16()
+    {
+        QByteArray bs(Superblock::fatLayout.length, 0);
+        QVERIFY(!Superblock::fatGeometry(bs).valid);
+
+        putLE<quint16>(bs, 0x0B, 512);
+        bs[0x0D] = 4;                     // 2 KiB clusters
+        putLE<quint16>(bs, 0x0E, 4);
+        bs[0x10] = 2;
+        putLE<quint16>(bs, 0x11, 512);
+        putLE<quint16>(bs, 0x16, 64);
+        putLE<quint32>(bs, 0x20, 40000);
+        bs[510] = char(0x55);
+        bs[511] = char(0xAA);
+
+        const Superblock::FatGeometry g = Superblock::fatGeometry(bs);
+        QVERIFY(g.valid);
+        QCOMPARE(g.fatBits, 16);
+        QCOMPARE(g.clusterCount, qint64(40000 - (4 + 2 * 64 + 32)) / 4);
+
+        QByteArray fat(g.sectorsPerFat * g.bytesPerSector, 0);
+        putLE<quint16>(fat, 2 * 2, 0xFFFF);
+        putLE<quint16>(fat, 3 * 2, 0x0005);
+        putLE<quint16>(fat, 5 * 2, 0xFFFF);
+        QCOMPARE(Superblock::fatUsedBytesFromTable(g, fat), qint64(3) * 2048);
+    }
+
+    void testFat32()
+    {
+        QByteArray bs(Superblock::fatLayout.length, 0);
+        putLE<quint16>(bs, 0x0B, 512);
+        bs[0x0D] = 8;                     // 4 KiB clusters
+        putLE<quint16>(bs, 0x0E, 32);
+        bs[0x10] = 2;
+        putLE<quint32>(bs, 0x20, 2097152);
+        putLE<quint32>(bs, 0x24, 2048);
+        putLE<quint16>(bs, 0x30, 1);
+        bs[510] = char(0x55);
+        bs[511] = char(0xAA);
+
+        const Superblock::FatGeometry g = Superblock::fatGeometry(bs);
+        QVERIFY(g.valid);
+        QCOMPARE(g.fatBits, 32);
+        QCOMPARE(g.fsInfoSector, qint64(1));
+
+        QByteArray fsInfo(512, 0);
+        putLE<quint32>(fsInfo, 0, 0x41615252);
+        putLE<quint32>(fsInfo, 484, 0x61417272);
+        putLE<quint32>(fsInfo, 488, 0xFFFFFFFF);
+        putLE<quint32>(fsInfo, 508, 0xAA550000);
+        QCOMPARE(Superblock::fatUsedBytesFromFsInfo(g, fsInfo), qint64(-1));
+
+        putLE<quint32>(fsInfo, 488, static_cast<quint32>(g.clusterCount - 100));
+        QCOMPARE(Superblock::fatUsedBytesFromFsInfo(g, fsInfo), qint64(100) * 4096);
+    }
+
+    void testLuks1()
+    {
+        QByteArray hdr(Superblock::luksLayout.length, 0);
+        QVERIFY(!Superblock::luksInfo(hdr).valid);
+
+        hdr.replace(0, 6, QByteArrayLiteral("LUKS\xba\xbe"));
+        putBE<quint16>(hdr, 6, 1);
+        hdr.replace(8, 3, "aes");
+        hdr.replace(40, 11, "xts-plain64");
+        hdr.replace(72, 6, "sha256");
+        putBE<quint32>(hdr, 104, 4096);   // payload offset in sectors
+        putBE<quint32>(hdr, 108, 64);     // key bytes
+        hdr.replace(168, 36, "0b1c7d32-3b5e-4e4d-9a3c-2f3d1e0a9b8c");
+        putBE<quint32>(hdr, 208, 0x00AC71F3);
+        putBE<quint32>(hdr, 208 + 3 * 48, 0x00AC71F3);
+        putBE<quint32>(hdr, 208 + 4 * 48, 0x0000DEAD);
+
+        const Superblock::LuksInfo info = Superblock::luksInfo(hdr);
+        QVERIFY(info.valid);
+        QCOMPARE(info.version, 1);
+        QCOMPARE(info.cipherName, QStringLiteral("aes"));
+        QCOMPARE(info.cipherMode, QStringLiteral("xts-plain64"));
+        QCOMPARE(info.hashName, QStringLiteral("sha256"));
+        QCOMPARE(info.keySize, qint64(512));
+        QCOMPARE(info.payloadOffset, qint64(4096) * 512);
+        QCOMPARE(info.uuid, QStringLiteral("0b1c7d32-3b5e-4e4d-9a3c-2f3d1e0a9b8c"));
+        QCOMPARE(info.activeKeySlots, 2);
+    }
+
+    void testLuks2()
+    {
+        QByteArray hdr(Superblock::luksLayout.length, 0);
+        hdr.replace(0, 6, QByteArrayLiteral("LUKS\xba\xbe"));
+        putBE<quint16>(hdr, 6, 2);
+        putBE<quint64>(hdr, 8, 16384);    // hdr_size
+        hdr.replace(168, 36, "5a6f1d2e-8c4b-4f3a-b1e2-7d9c0a8b6e5f");
+
+        const QByteArray json = "{\"keyslots\":{\"0\":{\"type\":\"luks2\",\"key_size\":64},\"2\":{\"type\":\"luks2\",\"key_size\":64}},"
+                                "\"segments\":{\"0\":{\"type\":\"crypt\",\"offset\":\"16777216\",\"size\":\"dynamic\",\"encryption\":\"aes-xts-plain64\"}},"
+                                "\"digests\":{\"0\":{\"type\":\"pbkdf2\",\"hash\":\"sha256\"}}}";
+        hdr.replace(4096, json.size(), json);
+
+        Superblock::LuksInfo info = Superblock::luksInfo(hdr);
+        QVERIFY(info.valid);
+        QCOMPARE(info.version, 2);
+        QCOMPARE(info.cipherName, QStringLiteral("aes"));
+        QCOMPARE(info.cipherMode, QStringLiteral("xts-plain64"));
+        QCOMPARE(info.hashName, QStringLiteral("sha256"));
+        QCOMPARE(info.keySize, qint64(512));
+        QCOMPARE(info.payloadOffset, qint64(16777216));
+        QCOMPARE(info.uuid, QStringLiteral("5a6f1d2e-8c4b-4f3a-b1e2-7d9c0a8b6e5f"));
+        QCOMPARE(info.activeKeySlots, 2);
+
+        // The JSON area does not fit into the data that was read
+        putBE<quint64>(hdr, 8, 32768);
+        QCOMPARE(Superblock::luksHeaderSize(hdr), qint64(32768));
+        QVERIFY(!Superblock::luksInfo(hdr).valid);
+    }
+};
+
+QTEST_GUILESS_MAIN(SuperblockTest)
+
+#include "test_superblock.moc"